@@ -18,6 +18,8 @@ struct zmk_behavior_binding {
     zmk_behavior_local_id_t local_id;
 #endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
     const char *behavior_dev;
+    // Resolved device for `behavior_dev`, or NULL if the binding must be looked up by name.
+    const struct device *device;
     uint32_t param1;
     uint32_t param2;
 };
@@ -45,6 +47,17 @@ struct zmk_behavior_binding_event {
  */
 const struct device *zmk_behavior_get_binding(const char *name);
 
+/**
+ * @brief Get the behavior device for a binding.
+ *
+ * @param binding Behavior binding to get the device for.
+ *
+ * @retval Pointer to the binding's resolved device, if it has one.
+ * @retval The result of zmk_behavior_get_binding() for the binding's name otherwise.
+ * @retval NULL if the behavior is not found or its initialization function failed.
+ */
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding);
+
 /**
  * @brief Invoke a behavior given its binding and invoking event details.
  *
@@ -77,3 +90,11 @@ zmk_behavior_local_id_t zmk_behavior_get_local_id(const char *name);
  * @retval NULL if the behavior is not found or its initialization function failed.
  */
 const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_t local_id);
+
+/**
+ * @brief Get a hash of the local IDs and names of the behaviors which can run on a split
+ * peripheral.
+ *
+ * Two devices with the same hash map the same local IDs to the same behaviors.
+ */
+uint32_t zmk_behavior_local_id_table_hash(void);
@@ -12,3 +12,53 @@
 
 int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
                            const struct zmk_behavior_binding behavior, bool press, uint32_t wait);
+
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+enum zmk_behavior_queue_step_type {
+    // Press, release or tap the encoded keycode in param, depending on the mode.
+    ZMK_BEHAVIOR_QUEUE_STEP_KEY,
+    ZMK_BEHAVIOR_QUEUE_STEP_MODE_TAP,
+    ZMK_BEHAVIOR_QUEUE_STEP_MODE_PRESS,
+    ZMK_BEHAVIOR_QUEUE_STEP_MODE_RELEASE,
+    // Set the time in milliseconds between pressing and releasing a tapped key to param.
+    ZMK_BEHAVIOR_QUEUE_STEP_TAP_TIME,
+    // Set the time in milliseconds to wait after each key step to param.
+    ZMK_BEHAVIOR_QUEUE_STEP_WAIT_TIME,
+    // Any step the behavior queue can't run itself. Sequences must not contain these.
+    ZMK_BEHAVIOR_QUEUE_STEP_OTHER,
+};
+
+struct zmk_behavior_queue_step {
+    uint8_t type;
+    uint32_t param;
+};
+
+enum zmk_behavior_queue_key_mode {
+    ZMK_BEHAVIOR_QUEUE_KEY_TAP,
+    ZMK_BEHAVIOR_QUEUE_KEY_PRESS,
+    ZMK_BEHAVIOR_QUEUE_KEY_RELEASE,
+};
+
+/**
+ * A run of key steps which the behavior queue runs directly from a constant table, taking up a
+ * single queue entry no matter how many steps it has.
+ */
+struct zmk_behavior_queue_sequence {
+    const struct zmk_behavior_queue_step *steps;
+    // Bindings the steps were built from, which are only used for logging.
+    const struct zmk_behavior_binding *bindings;
+    uint16_t start;
+    uint16_t count;
+    enum zmk_behavior_queue_key_mode mode;
+    uint32_t tap_ms;
+    uint32_t wait_ms;
+};
+
+/**
+ * Queues a sequence of key steps to run after any behaviors already in the queue.
+ */
+int zmk_behavior_queue_add_sequence(const struct zmk_behavior_binding_event *event,
+                                    const struct zmk_behavior_queue_sequence *sequence);
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
@@ -104,9 +104,35 @@ int zmk_endpoint_send_report(uint16_t usage_page);
  * Sends the HID mouse report to the selected endpoint.
  */
 int zmk_endpoint_send_mouse_report();
+
+/**
+ * @returns true if the selected endpoint has a mouse report queued which it hasn't started sending
+ * to the host yet.
+ */
+bool zmk_endpoint_mouse_report_waiting(void);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 /**
  * Clears all HID reports for the selected endpoint.
  */
 void zmk_endpoint_clear_reports(void);
+
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+struct zmk_endpoint_report_stats {
+    /** Number of keyboard/consumer reports handed to a transport. */
+    uint32_t sent;
+    /** Number of reports which were skipped because the host already has the same report. */
+    uint32_t coalesced;
+};
+
+/**
+ * Gets the counts of reports sent and coalesced since boot.
+ */
+void zmk_endpoint_get_report_stats(struct zmk_endpoint_report_stats *stats);
+
+/**
+ * Called by transports when the endpoint takes a waiting keyboard or consumer report, to hand over
+ * the reports queued since. Safe to call from any context.
+ */
+void zmk_endpoint_report_tx_ready(void);
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
@@ -10,8 +10,13 @@
 #include <zephyr/kernel.h>
 #include <zephyr/types.h>
 
+struct zmk_event_subscription;
+
 struct zmk_event_type {
     const char *name;
+    // Bounds of this event type's contiguous run in the sorted `.event_subscription.*` sections
+    const struct zmk_event_subscription *subscriptions_start;
+    const struct zmk_event_subscription *subscriptions_end;
 };
 
 typedef struct {
@@ -43,8 +48,21 @@ struct zmk_event_subscription {
     struct event_type *as_##event_type(const zmk_event_t *eh);                                     \
     extern const struct zmk_event_type zmk_event_##event_type;
 
+#define ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, part)                                           \
+    __attribute__((__section__(".event_subscription." STRINGIFY(event_type) "." #part)))
+
 #define ZMK_EVENT_IMPL(event_type)                                                                 \
-    const struct zmk_event_type zmk_event_##event_type = {.name = STRINGIFY(event_type)};          \
+    const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
+        zmk_event_subscriptions_start_##event_type[0] __used                                       \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, 0) = {};                                        \
+    const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
+        zmk_event_subscriptions_end_##event_type[0] __used                                         \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(event_type, 2) = {};                                        \
+    const struct zmk_event_type zmk_event_##event_type = {                                         \
+        .name = STRINGIFY(event_type),                                                             \
+        .subscriptions_start = zmk_event_subscriptions_start_##event_type,                         \
+        .subscriptions_end = zmk_event_subscriptions_end_##event_type,                             \
+    };                                                                                             \
     const struct zmk_event_type *zmk_event_ref_##event_type __used                                 \
         __attribute__((__section__(".event_type"))) = &zmk_event_##event_type;                     \
     struct event_type##_event copy_raised_##event_type(const struct event_type *ev) {              \
@@ -67,7 +85,7 @@ struct zmk_event_subscription {
     extern const struct zmk_listener zmk_listener_##mod;                                           \
     const Z_DECL_ALIGN(struct zmk_event_subscription)                                              \
         _CONCAT(_CONCAT(zmk_event_sub_, mod), ev_type) __used                                      \
-        __attribute__((__section__(".event_subscription"))) = {                                    \
+        ZMK_EVENT_SUBSCRIPTION_SECTION(ev_type, 1) = {                                             \
             .event_type = &zmk_event_##ev_type,                                                    \
             .listener = &zmk_listener_##mod,                                                       \
     };
@@ -84,4 +102,76 @@ struct zmk_event_subscription {
 int zmk_event_manager_raise(zmk_event_t *event);
 int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener);
 int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener);
-int zmk_event_manager_release(zmk_event_t *event);
\ No newline at end of file
+int zmk_event_manager_release(zmk_event_t *event);
+/**
+ * @brief Events which a listener has captured and will release later, in the order they were
+ * captured.
+ *
+ * Use ZMK_EVENT_DEFERRAL_DEFINE() to create one.
+ */
+struct zmk_event_deferral {
+    // Listener the events are re-raised at when released.
+    const struct zmk_listener *listener;
+    uint8_t *slots;
+    uint16_t slot_size;
+    uint16_t capacity;
+    // Number of events captured since the last release started.
+    uint16_t len;
+    // Number of captured events with each key, for events deferred with a key.
+    uint8_t *key_counts;
+    uint16_t key_count;
+};
+
+/**
+ * @brief Define a zmk_event_deferral.
+ *
+ * @param _name Name of the struct zmk_event_deferral to define.
+ * @param mod Name of the listener, as passed to ZMK_LISTENER(), which captures the events.
+ * @param slot_type Type large enough to hold any event which will be deferred.
+ * @param _capacity Maximum number of events which can be held at once.
+ * @param _key_count Number of distinct keys, such as key positions, that can be looked up with
+ * zmk_event_deferral_has_key().
+ */
+#define ZMK_EVENT_DEFERRAL_DEFINE(_name, mod, slot_type, _capacity, _key_count)                    \
+    extern const struct zmk_listener zmk_listener_##mod;                                           \
+    static slot_type _CONCAT(_name, _slots)[_capacity];                                            \
+    static uint8_t _CONCAT(_name, _key_counts)[_key_count];                                        \
+    static struct zmk_event_deferral _name = {                                                     \
+        .listener = &zmk_listener_##mod,                                                           \
+        .slots = (uint8_t *)_CONCAT(_name, _slots),                                                \
+        .slot_size = sizeof(slot_type),                                                            \
+        .capacity = _capacity,                                                                     \
+        .key_counts = _CONCAT(_name, _key_counts),                                                 \
+        .key_count = _key_count,                                                                   \
+    };
+
+/**
+ * @brief Hold a copy of @p event until zmk_event_deferral_release() is called.
+ *
+ * This may be called while the deferral is being released, including with the event that is
+ * currently being released, in which case it is held again after any events which were already
+ * held again.
+ *
+ * @param size Size of the full event struct, including the header.
+ * @param key Key to count the event under for zmk_event_deferral_has_key(), or -1 for none.
+ *
+ * @retval 0 If the event was held.
+ * @retval -ENOMEM If the deferral is full.
+ * @retval -EINVAL If @p size is larger than the deferral's slots.
+ */
+int zmk_event_deferral_defer(struct zmk_event_deferral *deferral, const zmk_event_t *event,
+                             size_t size, int32_t key);
+
+/**
+ * @brief Check whether an event with @p key has been held since the last release started.
+ */
+bool zmk_event_deferral_has_key(const struct zmk_event_deferral *deferral, int32_t key);
+
+/**
+ * @brief Re-raise every held event at the deferral's listener, oldest first.
+ *
+ * Events deferred while releasing are held for the next release. The listener may start a
+ * nested release while handling a released event, which releases the events deferred so far
+ * before this release continues.
+ */
+void zmk_event_deferral_release(struct zmk_event_deferral *deferral);
@@ -385,6 +385,12 @@ struct zmk_hid_consumer_report *zmk_hid_get_consumer_report(void);
 
 #if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
 zmk_hid_boot_report_t *zmk_hid_get_boot_report();
+
+/**
+ * Converts a keyboard report body, which need not be the current report, to a boot report.
+ */
+void zmk_hid_keyboard_body_to_boot_report(const struct zmk_hid_keyboard_report_body *body,
+                                          zmk_hid_boot_report_t *boot);
 #endif
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
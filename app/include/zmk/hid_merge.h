@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zmk/hid.h>
+
+/**
+ * How aggressively a transport may fold a new report into one that hasn't been sent yet.
+ */
+enum zmk_hid_merge_mode {
+    // Merge only if the host will still see every change in the unsent report.
+    ZMK_HID_MERGE_LOSSLESS,
+    // Merge unless the result can't be represented.
+    ZMK_HID_MERGE_LATEST,
+    // Always merge, even if that loses changes.
+    ZMK_HID_MERGE_FORCE,
+};
+
+/**
+ * True if a bit changes from @p base to @p pending and changes back from @p pending to @p next, so
+ * replacing @p pending with @p next would hide that change from the host.
+ */
+bool zmk_hid_bits_revert(const uint8_t *base, const uint8_t *pending, const uint8_t *next,
+                         size_t len);
+
+/**
+ * Like zmk_hid_bits_revert(), but for reports which list the pressed usages in an array of
+ * @p width byte little-endian values.
+ */
+bool zmk_hid_usages_revert(const uint8_t *base, const uint8_t *pending, const uint8_t *next,
+                           size_t len, size_t width);
+
+bool zmk_hid_keyboard_body_reverts(const struct zmk_hid_keyboard_report_body *base,
+                                   const struct zmk_hid_keyboard_report_body *pending,
+                                   const struct zmk_hid_keyboard_report_body *next);
+
+bool zmk_hid_consumer_body_reverts(const struct zmk_hid_consumer_report_body *base,
+                                   const struct zmk_hid_consumer_report_body *pending,
+                                   const struct zmk_hid_consumer_report_body *next);
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+/**
+ * Folds @p next into @p pending, an unsent mouse report which follows @p base. Movement is summed
+ * rather than replaced, since it is relative.
+ *
+ * @returns true if @p pending was updated, or false if the reports can't be merged in @p mode.
+ */
+bool zmk_hid_mouse_body_merge(const struct zmk_hid_mouse_report_body *base,
+                              struct zmk_hid_mouse_report_body *pending,
+                              const struct zmk_hid_mouse_report_body *next,
+                              enum zmk_hid_merge_mode mode);
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -12,6 +12,41 @@
 int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *body);
 int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *body);
 
+/**
+ * @returns true if a keyboard report is queued which hasn't been handed to the stack yet.
+ */
+bool zmk_hog_keyboard_report_waiting(void);
+
+/**
+ * @returns true if a consumer report is queued which hasn't been handed to the stack yet.
+ */
+bool zmk_hog_consumer_report_waiting(void);
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *body);
+
+/**
+ * @returns true if a mouse report is queued which hasn't been handed to the stack yet.
+ */
+bool zmk_hog_mouse_report_waiting(void);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+
+struct zmk_hog_tx_stats {
+    // Reports waiting to be notified, not counting those in flight.
+    uint8_t queued;
+    // The most reports which have been waiting at once.
+    uint8_t max_queued;
+    // Notifications the stack hasn't finished sending yet.
+    uint8_t in_flight;
+    uint32_t sent;
+    // Reports folded into an earlier report which hadn't been notified yet.
+    uint32_t merged;
+    // Reports which were lost, or which overwrote a change the host never saw, because the queue
+    // was full, there was no connection, or the notification failed.
+    uint32_t dropped;
+};
+
+/**
+ * Gets statistics for the HID over GATT transmit queue.
+ */
+void zmk_hog_get_tx_stats(struct zmk_hog_tx_stats *stats);
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief Points along the path from a key changing state to the host receiving the report.
+ */
+enum zmk_latency_stage {
+    ZMK_LATENCY_STAGE_KSCAN_CAPTURE,
+    ZMK_LATENCY_STAGE_MSGQ_DEQUEUE,
+    ZMK_LATENCY_STAGE_POSITION_RAISED,
+    ZMK_LATENCY_STAGE_BEHAVIOR_INVOKED,
+    ZMK_LATENCY_STAGE_HID_LISTENER,
+    ZMK_LATENCY_STAGE_REPORT_SENT,
+    ZMK_LATENCY_STAGE_REPORT_DELIVERED,
+    ZMK_LATENCY_STAGE_COUNT,
+};
+
+struct zmk_latency_stats {
+    uint16_t count;
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+};
+
+/**
+ * @brief Get a timestamp suitable for passing to zmk_latency_trace_begin().
+ *
+ * Safe to call from any context, including ISRs.
+ */
+static inline uint32_t zmk_latency_now(void) { return k_cycle_get_32(); }
+
+/**
+ * @brief Start tracing a key event on the current thread.
+ *
+ * @param capture_cycles The zmk_latency_now() value taken when the key change was captured.
+ */
+void zmk_latency_trace_begin(uint32_t capture_cycles);
+
+/**
+ * @brief Record that the key event being traced on the current thread has reached @p stage.
+ *
+ * Only the first time a stage is reached is recorded. Calls from threads not tracing a key event
+ * are ignored.
+ */
+void zmk_latency_trace_mark(enum zmk_latency_stage stage);
+
+/**
+ * @brief Finish tracing the current key event and add it to the latency history.
+ */
+void zmk_latency_trace_end(void);
+
+/**
+ * @brief Record that a report previously sent to the host has been delivered.
+ *
+ * Safe to call from any context, including ISRs.
+ */
+void zmk_latency_report_delivered(void);
+
+/**
+ * @brief Get statistics for the time from capture to @p stage over the recent history.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If @p stage is not a valid stage.
+ * @retval -ENODATA If no recent key event reached @p stage.
+ */
+int zmk_latency_get_stats(enum zmk_latency_stage stage, struct zmk_latency_stats *stats);
+
+/**
+ * @brief Clear the latency history.
+ */
+void zmk_latency_reset(void);
+
+const char *zmk_latency_stage_name(enum zmk_latency_stage stage);
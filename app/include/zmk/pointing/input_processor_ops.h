@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/input/input.h>
+
+#include <dt-bindings/zmk/input_transform.h>
+
+/*
+ * The work done by the built in input processors, shared between their drivers and the fused
+ * processor chains input listeners generate from devicetree. The fused chains pass codes and
+ * parameters known at build time, so the compiler can unroll the code searches and replace the
+ * divisions with multiplications.
+ */
+
+static inline int zmk_input_processor_code_idx(uint16_t code, const uint16_t *codes, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (codes[i] == code) {
+            return i;
+        }
+    }
+
+    return -ENODEV;
+}
+
+/**
+ * Multiplies the event's value by @p mul / @p div, adding to and updating @p remainder if it isn't
+ * NULL so no movement is lost to rounding.
+ */
+static inline void zmk_input_processor_scale(struct input_event *event, uint32_t mul, uint32_t div,
+                                             int16_t *remainder) {
+    int32_t value_mul = event->value * (int32_t)mul;
+
+    if (remainder) {
+        value_mul += *remainder;
+    }
+
+    int32_t scaled = value_mul / (int32_t)div;
+
+    if (remainder) {
+        *remainder = value_mul - (scaled * (int32_t)div);
+    }
+
+    event->value = scaled;
+}
+
+/**
+ * Applies the INPUT_TRANSFORM_* flags in @p flags to an event whose code may be in @p x_codes or
+ * @p y_codes.
+ */
+static inline void zmk_input_processor_transform(struct input_event *event, uint32_t flags,
+                                                 const uint16_t *x_codes, size_t x_codes_len,
+                                                 const uint16_t *y_codes, size_t y_codes_len) {
+    if (flags & INPUT_TRANSFORM_XY_SWAP) {
+        int idx = zmk_input_processor_code_idx(event->code, x_codes, x_codes_len);
+        if (idx >= 0) {
+            event->code = y_codes[idx];
+        } else {
+            idx = zmk_input_processor_code_idx(event->code, y_codes, y_codes_len);
+
+            if (idx >= 0) {
+                event->code = x_codes[idx];
+            }
+        }
+    }
+
+    if ((flags & INPUT_TRANSFORM_X_INVERT &&
+         zmk_input_processor_code_idx(event->code, x_codes, x_codes_len) >= 0) ||
+        (flags & INPUT_TRANSFORM_Y_INVERT &&
+         zmk_input_processor_code_idx(event->code, y_codes, y_codes_len) >= 0)) {
+        event->value = -event->value;
+    }
+}
+
+/**
+ * Replaces the event's code using @p map, a list of pairs of codes to match and codes to replace
+ * them with.
+ *
+ * @returns true if the code was replaced.
+ */
+static inline bool zmk_input_processor_map_code(struct input_event *event, const uint16_t *map,
+                                                size_t map_len) {
+    for (size_t i = 0; i < map_len / 2; i++) {
+        if (map[i * 2] == event->code) {
+            event->code = map[(i * 2) + 1];
+            return true;
+        }
+    }
+
+    return false;
+}
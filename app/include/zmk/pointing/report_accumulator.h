@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Changes to the mouse report from one input sync.
+ */
+struct zmk_pointing_report_delta {
+    /** Whether x and y should be set in the report, even if both are zero. */
+    bool movement;
+    /** Whether scroll_x and scroll_y should be set in the report, even if both are zero. */
+    bool scroll;
+    int32_t x;
+    int32_t y;
+    int32_t scroll_x;
+    int32_t scroll_y;
+    uint8_t button_set;
+    uint8_t button_clear;
+};
+
+struct zmk_pointing_report_stats {
+    /** Deltas passed to zmk_pointing_report_accumulate(). */
+    uint32_t generated;
+    /** Reports handed to the endpoint. */
+    uint32_t sent;
+    /** Deltas folded into a report which was still waiting for the endpoint to be ready. */
+    uint32_t coalesced;
+    /** Reports the endpoint failed to send. */
+    uint32_t dropped;
+};
+
+/**
+ * Adds a delta to the next mouse report.
+ *
+ * The report is sent right away if the endpoint has no earlier mouse report waiting to go to the
+ * host. Otherwise, the delta is summed with any others until the endpoint takes the waiting report,
+ * so a sensor reporting faster than the host polls doesn't overflow the endpoint's queue.
+ * Movement which doesn't fit in one report is carried over to the next.
+ */
+void zmk_pointing_report_accumulate(const struct zmk_pointing_report_delta *delta);
+
+/**
+ * Called by transports when the endpoint takes a waiting mouse report, to send anything
+ * accumulated since. Safe to call from any context.
+ */
+void zmk_pointing_report_tx_ready(void);
+
+void zmk_pointing_report_get_stats(struct zmk_pointing_report_stats *stats);
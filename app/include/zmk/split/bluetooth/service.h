@@ -37,3 +37,37 @@ struct zmk_split_input_event_payload {
     uint32_t value;
     uint8_t sync;
 } __packed;
+
+// Written by the central to request a sync. Times are uptimes in microseconds.
+struct zmk_split_clock_sync_request {
+    int64_t central_time;
+} __packed;
+
+// Notified by the peripheral in reply to a sync request.
+struct zmk_split_clock_sync_response {
+    int64_t central_time;
+    int64_t peripheral_time;
+} __packed;
+
+// Read by the central to check the peripheral maps behavior local IDs the same way it does.
+struct zmk_split_behavior_ids {
+    uint8_t crc16_ids;
+    uint32_t table_hash;
+} __packed;
+
+/*
+ * Position deltas notifications start with a sequence number, which increments by one with each
+ * notification, and the low 32 bits of the peripheral's uptime in milliseconds when the
+ * notification was built, little endian. Then come one or more entries, each two varints: the key
+ * position shifted left by one with the pressed state in the low bit, and how many milliseconds
+ * before the notification was built the key changed state.
+ *
+ * Reading the characteristic returns the sequence number of the last notification, followed by a
+ * bitmap of the pressed positions once that notification is applied.
+ */
+#define ZMK_SPLIT_POSITION_DELTAS_MAX_LEN 20
+#define ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN 5
+
+#define ZMK_SPLIT_POSITION_DELTA_KEY(position, pressed) (((position) << 1) | ((pressed) ? 1 : 0))
+#define ZMK_SPLIT_POSITION_DELTA_POSITION(key) ((key) >> 1)
+#define ZMK_SPLIT_POSITION_DELTA_PRESSED(key) ((key) & 1)
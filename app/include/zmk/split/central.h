@@ -46,3 +46,41 @@ int zmk_split_central_update_hid_indicator(zmk_hid_indicators_t indicators);
 int zmk_split_central_get_peripheral_battery_level(uint8_t source, uint8_t *level);
 
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+struct zmk_split_central_clock_offset {
+    // Peripheral uptime minus central uptime, in microseconds.
+    int64_t offset_us;
+    // Upper bound on how far offset_us may be from the true offset, in microseconds.
+    uint32_t error_us;
+    // Round trip time of the sync exchange the offset was measured with, in microseconds.
+    uint32_t round_trip_us;
+};
+
+/**
+ * @brief Get the current estimate of a peripheral's clock offset from the central's.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If @p source is not a valid peripheral source.
+ * @retval -ENODATA If the peripheral's clock hasn't been synced yet.
+ */
+int zmk_split_central_get_clock_offset(uint8_t source,
+                                       struct zmk_split_central_clock_offset *offset);
+
+/**
+ * @brief Convert a peripheral's uptime to the equivalent central uptime.
+ *
+ * @param source The peripheral source.
+ * @param peripheral_time The peripheral's uptime in milliseconds. Only the low 32 bits are used,
+ * so transports may send it truncated.
+ * @param local_time Set to the central's uptime in milliseconds on success.
+ *
+ * @retval 0 If successful.
+ * @retval -EINVAL If @p source is not a valid peripheral source.
+ * @retval -ENODATA If the peripheral's clock hasn't been synced yet.
+ */
+int zmk_split_central_peripheral_time_to_local(uint8_t source, uint32_t peripheral_time,
+                                               int64_t *local_time);
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
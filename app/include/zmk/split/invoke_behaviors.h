@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zmk/behavior.h>
+#include <zmk/varint.h>
+
+/*
+ * Behaviors invoked on a peripheral by local ID are sent as one or more entries, each four varints:
+ * the behavior's local ID, the key position shifted left by one with the pressed state in the low
+ * bit, and the two binding parameters. The event source isn't sent, since peripherals only ever
+ * run behaviors as if they came from their own keys.
+ */
+struct zmk_split_invoke_behaviors_entry {
+    zmk_behavior_local_id_t local_id;
+    uint32_t position;
+    bool pressed;
+    uint32_t param1;
+    uint32_t param2;
+};
+
+/**
+ * Appends an entry to @p buf.
+ *
+ * @returns The number of bytes written, or -ENOMEM if the entry doesn't fit in @p len bytes.
+ */
+static inline int
+zmk_split_invoke_behaviors_encode(const struct zmk_split_invoke_behaviors_entry *entry,
+                                  uint8_t *buf, size_t len) {
+    const uint32_t values[] = {
+        entry->local_id,
+        (entry->position << 1) | (entry->pressed ? 1 : 0),
+        entry->param1,
+        entry->param2,
+    };
+    size_t offset = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        int ret = zmk_varint_encode(values[i], buf + offset, len - offset);
+        if (ret < 0) {
+            return ret;
+        }
+
+        offset += ret;
+    }
+
+    return offset;
+}
+
+/**
+ * Reads the entry at the start of @p buf.
+ *
+ * @returns The number of bytes read, or -EINVAL if @p buf doesn't start with a complete entry.
+ */
+static inline int
+zmk_split_invoke_behaviors_decode(const uint8_t *buf, size_t len,
+                                  struct zmk_split_invoke_behaviors_entry *entry) {
+    uint32_t values[4];
+    size_t offset = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        int ret = zmk_varint_decode(buf + offset, len - offset, &values[i]);
+        if (ret < 0) {
+            return ret;
+        }
+
+        offset += ret;
+    }
+
+    if (values[0] > UINT16_MAX) {
+        return -EINVAL;
+    }
+
+    *entry = (struct zmk_split_invoke_behaviors_entry){
+        .local_id = values[0],
+        .position = values[1] >> 1,
+        .pressed = values[1] & 1,
+        .param1 = values[2],
+        .param2 = values[3],
+    };
+
+    return offset;
+}
@@ -30,6 +30,8 @@ enum zmk_split_transport_peripheral_event_type {
     ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT,
     ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_INPUT_EVENT,
     ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BATTERY_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT,
+    ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT,
 };
 
 struct zmk_split_transport_peripheral_event {
@@ -37,8 +39,12 @@ struct zmk_split_transport_peripheral_event {
 
     union {
         struct {
-            uint8_t position;
+            uint32_t position;
             uint8_t pressed;
+            // Uptime in milliseconds when the key changed state, in the clock of whichever side
+            // holds the event. Central transports convert it with
+            // zmk_split_central_peripheral_time_to_local() where they can.
+            int64_t timestamp;
         } key_position_event;
 
         struct {
@@ -58,6 +64,25 @@ struct zmk_split_transport_peripheral_event {
         struct {
             uint8_t level;
         } battery_event;
+
+        // Reply to ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK. All times are in microseconds.
+        struct {
+            // The central_time from the command being answered.
+            int64_t central_time;
+            // Peripheral uptime when the command was handled.
+            int64_t peripheral_time;
+            // Central uptime when the reply arrived. Filled in by the central transport on receipt,
+            // so it is last and isn't sent.
+            int64_t received_time;
+        } clock_sync_event;
+
+        // Reply to ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS.
+        struct {
+            // Whether the peripheral's local IDs are CRC16 hashes of the behavior names.
+            uint8_t crc16_ids;
+            // The peripheral's zmk_behavior_local_id_table_hash().
+            uint32_t table_hash;
+        } behavior_ids_event;
     } data;
 } __packed;
 
@@ -66,8 +91,14 @@ enum zmk_split_transport_central_command_type {
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT,
     ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS,
+    ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS,
 } __packed;
 
+// Small enough for a single BLE write with the default ATT MTU.
+#define ZMK_SPLIT_INVOKE_BEHAVIORS_MAX_LEN 20
+
 struct zmk_split_transport_central_command {
     enum zmk_split_transport_central_command_type type;
 
@@ -87,5 +118,19 @@ struct zmk_split_transport_central_command {
         struct {
             zmk_hid_indicators_t indicators;
         } set_hid_indicators;
+
+        struct {
+            // Central uptime in microseconds. Transports which queue commands refresh this just
+            // before actually sending it.
+            int64_t central_time;
+        } sync_clock;
+
+        // One or more invocations, encoded as described in <zmk/split/invoke_behaviors.h>. Only
+        // sent to peripherals whose reply to CHECK_BEHAVIOR_IDS showed they map local IDs to the
+        // same behaviors as the central.
+        struct {
+            uint8_t len;
+            uint8_t buf[ZMK_SPLIT_INVOKE_BEHAVIORS_MAX_LEN];
+        } invoke_behaviors;
     } data;
 } __packed;
\ No newline at end of file
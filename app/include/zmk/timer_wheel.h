@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/sys/dlist.h>
+
+struct zmk_timer;
+
+typedef void (*zmk_timer_handler_t)(struct zmk_timer *timer);
+
+/**
+ * @brief A one-shot deadline, run by the shared timer wheel.
+ *
+ * All timers share a single kernel timer. The wheel is not locked: timers must only be started
+ * and stopped from ZMK_WORK_CLASS_INPUT work, which is asserted. That is also where their handlers
+ * run and where key events are processed, so a stopped timer's handler is never run afterwards.
+ * Code running on other threads, such as input processors, must hand over to that work queue
+ * before invoking behaviors.
+ */
+struct zmk_timer {
+    sys_dnode_t node;
+    int64_t deadline;
+    zmk_timer_handler_t handler;
+};
+
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler);
+
+/**
+ * @brief Run the timer's handler once the uptime reaches @p deadline, in milliseconds.
+ *
+ * Restarts the timer if it is already pending. A deadline in the past runs the handler as soon
+ * as possible.
+ */
+void zmk_timer_start(struct zmk_timer *timer, int64_t deadline);
+
+/**
+ * @brief Stop the timer if it is pending.
+ *
+ * @returns true if the timer was pending.
+ */
+bool zmk_timer_stop(struct zmk_timer *timer);
+
+static inline bool zmk_timer_is_pending(const struct zmk_timer *timer) {
+    return sys_dnode_is_linked(&timer->node);
+}
+
+/**
+ * @brief Run the handlers of all timers with deadlines before @p timestamp.
+ *
+ * Called before raising a key event with @p timestamp, so a timeout which should have happened
+ * first is never handled after the event just because its work hadn't run yet.
+ */
+void zmk_timer_wheel_expire(int64_t timestamp);
@@ -6,11 +6,58 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
+#include <zmk/hid.h>
+
 int zmk_usb_hid_send_keyboard_report(void);
 int zmk_usb_hid_send_consumer_report(void);
+
+/**
+ * Sends a keyboard report with the given body instead of the current keyboard report.
+ */
+int zmk_usb_hid_send_keyboard_report_body(const struct zmk_hid_keyboard_report_body *body);
+
+/**
+ * Sends a consumer report with the given body instead of the current consumer report.
+ */
+int zmk_usb_hid_send_consumer_report_body(const struct zmk_hid_consumer_report_body *body);
+
+/**
+ * @returns true if a keyboard report is queued behind the one the endpoint is writing, if any.
+ */
+bool zmk_usb_hid_keyboard_report_waiting(void);
+
+/**
+ * @returns true if a consumer report is queued behind the one the endpoint is writing, if any.
+ */
+bool zmk_usb_hid_consumer_report_waiting(void);
+
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_usb_hid_send_mouse_report(void);
+
+/**
+ * @returns true if a mouse report is queued behind the one the endpoint is writing, if any.
+ */
+bool zmk_usb_hid_mouse_report_waiting(void);
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 void zmk_usb_hid_set_protocol(uint8_t protocol);
+
+struct zmk_usb_hid_tx_stats {
+    // Reports waiting to be sent, including any the endpoint is currently writing.
+    uint8_t queued;
+    // The most reports which have been waiting at once.
+    uint8_t max_queued;
+    uint32_t sent;
+    // Reports folded into an earlier report which hadn't been sent yet.
+    uint32_t merged;
+    // Reports which were lost, or which overwrote a change the host never saw, because the queue
+    // was full or the endpoint failed.
+    uint32_t dropped;
+};
+
+/**
+ * Gets statistics for the USB HID transmit queue.
+ */
+void zmk_usb_hid_get_tx_stats(struct zmk_usb_hid_tx_stats *stats);
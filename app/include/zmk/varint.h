@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+/**
+ * Maximum number of bytes needed to encode a uint32_t as a varint.
+ */
+#define ZMK_VARINT_MAX_LEN 5
+
+/**
+ * Encodes a value as an unsigned LEB128 varint, seven bits per byte with the high bit set on all
+ * but the last byte.
+ *
+ * @returns The number of bytes written, or -ENOMEM if @p len is too small.
+ */
+static inline int zmk_varint_encode(uint32_t value, uint8_t *buf, size_t len) {
+    size_t i = 0;
+
+    do {
+        if (i == len) {
+            return -ENOMEM;
+        }
+
+        buf[i] = value & 0x7F;
+        value >>= 7;
+
+        if (value) {
+            buf[i] |= 0x80;
+        }
+
+        i++;
+    } while (value);
+
+    return i;
+}
+
+/**
+ * Decodes an unsigned LEB128 varint.
+ *
+ * @returns The number of bytes read, or -EINVAL if @p buf does not start with a complete varint
+ * which fits in a uint32_t.
+ */
+static inline int zmk_varint_decode(const uint8_t *buf, size_t len, uint32_t *value) {
+    uint32_t result = 0;
+
+    for (size_t i = 0; i < MIN(len, ZMK_VARINT_MAX_LEN); i++) {
+        result |= (uint32_t)(buf[i] & 0x7F) << (7 * i);
+
+        if (!(buf[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+
+    return -EINVAL;
+}
@@ -1 +1,43 @@
+/*
+ * Copyright (c) 2023 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief How urgently work needs to run, which decides the work queue it is submitted to.
+ */
+enum zmk_work_class {
+    /**
+     * Key events, the keymap and behaviors. Runs on the dedicated input work queue if
+     * CONFIG_ZMK_INPUT_WORK_QUEUE is enabled, otherwise on the system work queue. All work which
+     * touches keymap or behavior state must use this class, since none of it is locked.
+     */
+    ZMK_WORK_CLASS_INPUT,
+    /**
+     * Work which should not wait long, but may block for a while, e.g. saving settings. Runs on
+     * the system work queue.
+     */
+    ZMK_WORK_CLASS_HOUSEKEEPING,
+    /**
+     * Work which can wait for everything else, e.g. lighting effects. Runs on the low priority
+     * work queue if CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE is enabled, otherwise on the system work
+     * queue.
+     */
+    ZMK_WORK_CLASS_BACKGROUND,
+};
+
+/**
+ * @brief The class a subsystem's work is pinned to by its CONFIG_ZMK_<subsys>_WORK_CLASS choice.
+ */
+#define ZMK_WORK_CLASS_FOR(subsys)                                                                 \
+    (IS_ENABLED(CONFIG_ZMK_##subsys##_WORK_CLASS_BACKGROUND) ? ZMK_WORK_CLASS_BACKGROUND           \
+                                                              : ZMK_WORK_CLASS_HOUSEKEEPING)
+
+struct k_work_q *zmk_workqueue_get(enum zmk_work_class work_class);
+
 struct k_work_q *zmk_workqueue_lowprio_work_q(void);
@@ -31,3 +31,25 @@ int kscan_gpio_pin_get(const struct kscan_gpio *gpio, struct kscan_gpio_port_sta
 
     return (state->value & BIT(gpio->spec.pin)) != 0;
 }
+
+int kscan_gpio_list_get(const struct kscan_gpio_list *list, uint32_t *value) {
+    *value = 0;
+
+    for (size_t i = 0; i < list->len;) {
+        const struct device *port = list->gpios[i].spec.port;
+        gpio_port_value_t port_value;
+
+        const int err = gpio_port_get(port, &port_value);
+        if (err) {
+            return err;
+        }
+
+        for (; i < list->len && list->gpios[i].spec.port == port; i++) {
+            const struct kscan_gpio *gpio = &list->gpios[i];
+
+            *value |= ((port_value >> gpio->spec.pin) & 1) << gpio->index;
+        }
+    }
+
+    return 0;
+}
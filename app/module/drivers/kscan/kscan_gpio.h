@@ -59,3 +59,17 @@ void kscan_gpio_list_sort_by_port(struct kscan_gpio_list *list);
  * @retval -EWOULDBLOCK if operation would block.
  */
 int kscan_gpio_pin_get(const struct kscan_gpio *gpio, struct kscan_gpio_port_state *state);
+
+/**
+ * Get the logical levels of all pins in a list.
+ *
+ * The list must be sorted by kscan_gpio_list_sort_by_port(), so that each port is read only once.
+ *
+ * @param list The input pins to read. Every pin's index must be less than 32.
+ * @param value Set to a bitmask with bit N set if the pin with index N is active.
+ *
+ * @retval 0 If successful.
+ * @retval -EIO I/O error when accessing an external GPIO chip.
+ * @retval -EWOULDBLOCK if operation would block.
+ */
+int kscan_gpio_list_get(const struct kscan_gpio_list *list, uint32_t *value);
@@ -4,7 +4,10 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include "kscan_gpio.h"
+
 #include <zmk/debounce.h>
+#include <zmk/kscan_governor.h>
 
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
@@ -37,8 +40,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_release_ms))
 #endif
 
-#define KSCAN_GPIO_CFG_INIT(idx, inst_idx)                                                         \
-    GPIO_DT_SPEC_GET_BY_IDX(DT_DRV_INST(inst_idx), gpios, idx)
+#define KSCAN_GPIO_CFG_INIT(idx, inst_idx) KSCAN_GPIO_GET_BY_IDX(DT_DRV_INST(inst_idx), gpios, idx)
 
 #define INST_INTR_DEFINED(n) DT_INST_NODE_HAS_PROP(n, interrupt_gpios)
 
@@ -55,9 +57,22 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 struct kscan_charlieplex_data {
     const struct device *dev;
+    /** The same pins as config->cells, sorted by port so each port is read once per row. */
+    struct kscan_gpio_list inputs;
     kscan_callback_t callback;
     struct k_work_delayable work;
     int64_t scan_time; /* Timestamp of the current or scheduled scan. */
+    /** Milliseconds between the previous scan and the current one, as counted by the debouncer. */
+    int32_t scan_period_ms;
+    /** Timestamp from which the next scan must read every row, not just the settling ones. */
+    int64_t full_scan_time;
+    /** Bitmask of the driven pins which have a key latched as pressed. */
+    uint32_t pressed_rows;
+    /** Bitmask of the driven pins which have a key the debouncer has not settled on. */
+    uint32_t settling_rows;
+    /** Whether every pin is known to be configured as an input. */
+    bool pins_are_inputs;
+    struct zmk_kscan_governor governor;
     struct gpio_callback irq_callback;
     /**
      * Current state of the matrix as a flattened 2D array of length
@@ -66,19 +81,11 @@ struct kscan_charlieplex_data {
     struct zmk_debounce_state *charlieplex_state;
 };
 
-struct kscan_gpio_list {
-    const struct gpio_dt_spec *gpios;
-    size_t len;
-};
-
-/** Define a kscan_gpio_list from a compile-time GPIO array. */
-#define KSCAN_GPIO_LIST(gpio_array)                                                                \
-    ((struct kscan_gpio_list){.gpios = gpio_array, .len = ARRAY_SIZE(gpio_array)})
-
 struct kscan_charlieplex_config {
     struct kscan_gpio_list cells;
     struct zmk_debounce_config debounce_config;
     int32_t debounce_scan_period_ms;
+    int32_t keep_alive_period_ms;
     int32_t poll_period_ms;
     bool use_interrupt;
     const struct gpio_dt_spec interrupt;
@@ -121,15 +128,10 @@ static int kscan_charlieplex_set_as_output(const struct gpio_dt_spec *gpio) {
         return -ENODEV;
     }
 
-    int err = gpio_pin_configure_dt(gpio, GPIO_OUTPUT);
+    // Set the level as part of configuring the pin, so driving it takes a single call.
+    int err = gpio_pin_configure_dt(gpio, GPIO_OUTPUT_ACTIVE);
     if (err) {
         LOG_ERR("Unable to configure pin %u on %s for output", gpio->pin, gpio->port->name);
-        return err;
-    }
-
-    err = gpio_pin_set_dt(gpio, 1);
-    if (err) {
-        LOG_ERR("Failed to set output pin %u active: %i", gpio->pin, err);
     }
     return err;
 }
@@ -138,7 +140,7 @@ static int kscan_charlieplex_set_all_as_input(const struct device *dev) {
     const struct kscan_charlieplex_config *config = dev->config;
     int err = 0;
     for (int i = 0; i < config->cells.len; i++) {
-        err = kscan_charlieplex_set_as_input(&config->cells.gpios[i]);
+        err = kscan_charlieplex_set_as_input(&config->cells.gpios[i].spec);
         if (err) {
             return err;
         }
@@ -149,18 +151,16 @@ static int kscan_charlieplex_set_all_as_input(const struct device *dev) {
 
 static int kscan_charlieplex_set_all_outputs(const struct device *dev, const int value) {
     const struct kscan_charlieplex_config *config = dev->config;
+    struct kscan_charlieplex_data *data = dev->data;
+    const gpio_flags_t flags = value ? GPIO_OUTPUT_ACTIVE : GPIO_OUTPUT_INACTIVE;
 
-    for (int i = 0; i < config->cells.len; i++) {
-        const struct gpio_dt_spec *gpio = &config->cells.gpios[i];
-        int err = gpio_pin_configure_dt(gpio, GPIO_OUTPUT);
-        if (err) {
-            LOG_ERR("Unable to configure pin %u on %s for input", gpio->pin, gpio->port->name);
-            return err;
-        }
+    data->pins_are_inputs = false;
 
-        err = gpio_pin_set_dt(gpio, value);
+    for (int i = 0; i < config->cells.len; i++) {
+        const struct gpio_dt_spec *gpio = &config->cells.gpios[i].spec;
+        int err = gpio_pin_configure_dt(gpio, flags);
         if (err) {
-            LOG_ERR("Failed to set output %i to %i: %i", i, value, err);
+            LOG_ERR("Unable to set output %i to %i: %i", i, value, err);
             return err;
         }
     }
@@ -172,9 +172,12 @@ static int kscan_charlieplex_set_all_outputs(const struct device *dev, const int
 
 static int kscan_charlieplex_disconnect_all(const struct device *dev) {
     const struct kscan_charlieplex_config *config = dev->config;
+    struct kscan_charlieplex_data *data = dev->data;
+
+    data->pins_are_inputs = false;
 
     for (int i = 0; i < config->cells.len; i++) {
-        const struct gpio_dt_spec *gpio = &config->cells.gpios[i];
+        const struct gpio_dt_spec *gpio = &config->cells.gpios[i].spec;
         int err = gpio_pin_configure_dt(gpio, GPIO_DISCONNECTED);
         if (err) {
             LOG_ERR("Unable to configure pin %u on %s for input", gpio->pin, gpio->port->name);
@@ -215,10 +218,13 @@ static void kscan_charlieplex_irq_callback(const struct device *port, struct gpi
                                            const gpio_port_pins_t _pin) {
     struct kscan_charlieplex_data *data =
         CONTAINER_OF(cb, struct kscan_charlieplex_data, irq_callback);
+    const struct kscan_charlieplex_config *config = data->dev->config;
 
     // Disable our interrupt to avoid re-entry while we scan.
     kscan_charlieplex_interrupt_configure(data->dev, GPIO_INT_DISABLE);
+    // The interrupt fired on the change itself, so only one scan period of it has elapsed.
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
     k_work_reschedule(&data->work, K_NO_WAIT);
 }
 
@@ -227,6 +233,20 @@ static void kscan_charlieplex_read_continue(const struct device *dev) {
     struct kscan_charlieplex_data *data = dev->data;
 
     data->scan_time += config->debounce_scan_period_ms;
+    data->scan_period_ms = config->debounce_scan_period_ms;
+
+    k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
+}
+
+static void kscan_charlieplex_read_keep_alive(const struct device *dev, const int32_t period_ms) {
+    struct kscan_charlieplex_data *data = dev->data;
+
+    // Nothing can change until a held key is released or another is pressed, so wait for the
+    // next full scan.
+    const int64_t next_scan_time = MAX(data->scan_time + period_ms, data->full_scan_time);
+
+    data->scan_period_ms = next_scan_time - data->scan_time;
+    data->scan_time = next_scan_time;
 
     k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
 }
@@ -235,79 +255,144 @@ static void kscan_charlieplex_read_end(const struct device *dev) {
     struct kscan_charlieplex_data *data = dev->data;
     const struct kscan_charlieplex_config *config = dev->config;
 
+    // Whatever wakes the next scan could be any key, so it must read every row.
+    data->full_scan_time = 0;
+
     if (config->use_interrupt) {
         // Return to waiting for an interrupt.
         kscan_charlieplex_interrupt_enable(dev);
     } else {
-        data->scan_time += config->poll_period_ms;
+        data->scan_period_ms = zmk_kscan_governor_poll_period_ms(config->poll_period_ms);
+        data->scan_time += data->scan_period_ms;
 
         // Return to polling slowly.
         k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
     }
 }
 
-static int kscan_charlieplex_read(const struct device *dev) {
+/**
+ * Drive one pin and debounce every key it powers, reading each input port just once.
+ */
+static int kscan_charlieplex_read_row(const struct device *dev, const int row, bool *changed) {
     struct kscan_charlieplex_data *data = dev->data;
     const struct kscan_charlieplex_config *config = dev->config;
-    bool continue_scan = false;
+    const struct gpio_dt_spec *out_gpio = &config->cells.gpios[row].spec;
 
-    // NOTE: RR vs MATRIX: set all pins as input, in case there was a failure on a
-    // previous scan, and one of the pins is still set as output
-    int err = kscan_charlieplex_set_all_as_input(dev);
+    int err = kscan_charlieplex_set_as_output(out_gpio);
     if (err) {
         return err;
     }
 
-    // Scan the matrix.
-    for (int row = 0; row < config->cells.len; row++) {
-        const struct gpio_dt_spec *out_gpio = &config->cells.gpios[row];
-        err = kscan_charlieplex_set_as_output(out_gpio);
+#if CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS > 0
+    k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS);
+#endif
+
+    uint32_t active;
+    err = kscan_gpio_list_get(&data->inputs, &active);
+    if (err) {
+        LOG_ERR("Failed to read inputs for output %i: %i", row, err);
+        return err;
+    }
+
+    bool row_pressed = false;
+    bool row_settling = false;
+
+    for (int col = 0; col < config->cells.len; col++) {
+        if (col == row) {
+            continue; // pin can't drive itself
+        }
+        const int index = state_index(config, row, col);
+
+        struct zmk_debounce_state *state = &data->charlieplex_state[index];
+        zmk_debounce_update(state, active & BIT(col), data->scan_period_ms,
+                            &config->debounce_config);
+
+        // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
+        // setup, we can update in the same loop.
+        if (zmk_debounce_get_changed(state)) {
+            const bool pressed = zmk_debounce_is_pressed(state);
+
+            LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
+            data->callback(dev, row, col, pressed);
+            *changed = true;
+        }
+
+        row_pressed = row_pressed || zmk_debounce_is_pressed(state);
+        row_settling = row_settling || zmk_debounce_is_settling(state);
+    }
+
+    WRITE_BIT(data->pressed_rows, row, row_pressed);
+    WRITE_BIT(data->settling_rows, row, row_settling);
+
+    err = kscan_charlieplex_set_as_input(out_gpio);
+    if (err) {
+        return err;
+    }
+#if CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BETWEEN_OUTPUTS > 0
+    k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BETWEEN_OUTPUTS);
+#endif
+
+    return 0;
+}
+
+static int kscan_charlieplex_read(const struct device *dev) {
+    struct kscan_charlieplex_data *data = dev->data;
+    const struct kscan_charlieplex_config *config = dev->config;
+
+    // NOTE: RR vs MATRIX: every pin is left as an output while waiting for an interrupt, and one
+    // may still be an output after a failed scan. Otherwise, each scan leaves them all as inputs.
+    if (!data->pins_are_inputs) {
+        int err = kscan_charlieplex_set_all_as_input(dev);
         if (err) {
             return err;
         }
 
-#if CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS > 0
-        k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BEFORE_INPUTS);
-#endif
+        data->pins_are_inputs = true;
+    }
 
-        for (int col = 0; col < config->cells.len; col++) {
-            if (col == row) {
-                continue; // pin can't drive itself
-            }
-            const struct gpio_dt_spec *in_gpio = &config->cells.gpios[col];
-            const int index = state_index(config, row, col);
-
-            struct zmk_debounce_state *state = &data->charlieplex_state[index];
-            zmk_debounce_update(state, gpio_pin_get_dt(in_gpio), config->debounce_scan_period_ms,
-                                &config->debounce_config);
-
-            // NOTE: RR vs MATRIX: because we don't need an input/output => row/column
-            // setup, we can update in the same loop.
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
-
-                LOG_DBG("Sending event at %i,%i state %s", row, col, pressed ? "on" : "off");
-                data->callback(dev, row, col, pressed);
-            }
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+    // Rows with keys the debouncer hasn't settled on are read on every scan. Every other row is
+    // only read by a full scan, once per keep-alive period.
+    uint32_t rows = data->settling_rows;
+
+    if (data->scan_time >= data->full_scan_time) {
+        rows = BIT64_MASK(config->cells.len);
+        data->full_scan_time = data->scan_time + config->keep_alive_period_ms;
+    }
+
+    bool changed = false;
+
+    for (int row = 0; row < config->cells.len; row++) {
+        if (!(rows & BIT(row))) {
+            continue;
         }
 
-        err = kscan_charlieplex_set_as_input(out_gpio);
+        int err = kscan_charlieplex_read_row(dev, row, &changed);
         if (err) {
+            data->pins_are_inputs = false;
             return err;
         }
-#if CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BETWEEN_OUTPUTS > 0
-        k_busy_wait(CONFIG_ZMK_KSCAN_CHARLIEPLEX_WAIT_BETWEEN_OUTPUTS);
-#endif
     }
 
-    if (continue_scan) {
-        // At least one key is pressed or the debouncer has not yet decided if
-        // it is pressed. Poll quickly until everything is released.
-        kscan_charlieplex_read_continue(dev);
-    } else {
+    switch (zmk_kscan_governor_update(&data->governor, data->scan_time, changed,
+                                      data->settling_rows != 0, data->pressed_rows != 0)) {
+    case ZMK_KSCAN_GOVERNOR_BURST:
+        if (data->settling_rows) {
+            // The debouncer has not yet decided if at least one key is pressed. Poll quickly
+            // until it has.
+            kscan_charlieplex_read_continue(dev);
+        } else {
+            // Keys are held, but none are changing.
+            kscan_charlieplex_read_keep_alive(dev, config->debounce_scan_period_ms);
+        }
+        break;
+    case ZMK_KSCAN_GOVERNOR_HELD:
+        // Keys are held, and none have changed for a while. Poll less often.
+        kscan_charlieplex_read_keep_alive(dev, zmk_kscan_governor_held_period_ms());
+        break;
+    default:
         // All keys are released. Return to normal.
         kscan_charlieplex_read_end(dev);
+        break;
     }
 
     return 0;
@@ -331,7 +416,10 @@ static int kscan_charlieplex_configure(const struct device *dev, const kscan_cal
 
 static int kscan_charlieplex_enable(const struct device *dev) {
     struct kscan_charlieplex_data *data = dev->data;
+    const struct kscan_charlieplex_config *config = dev->config;
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
+    data->full_scan_time = 0;
 
     // Read will automatically start interrupts/polling once done.
     return kscan_charlieplex_read(dev);
@@ -352,7 +440,7 @@ static int kscan_charlieplex_init_inputs(const struct device *dev) {
     const struct kscan_charlieplex_config *config = dev->config;
 
     for (int i = 0; i < config->cells.len; i++) {
-        int err = kscan_charlieplex_set_as_input(&config->cells.gpios[i]);
+        int err = kscan_charlieplex_set_as_input(&config->cells.gpios[i].spec);
         if (err) {
             return err;
         }
@@ -414,6 +502,11 @@ static int kscan_charlieplex_init(const struct device *dev) {
 
     data->dev = dev;
 
+    // Sort inputs by port so we can read each port just once per row.
+    kscan_gpio_list_sort_by_port(&data->inputs);
+
+    zmk_kscan_governor_init(&data->governor, dev->name);
+
     k_work_init_delayable(&data->work, kscan_charlieplex_work_handler);
 
 #if IS_ENABLED(CONFIG_PM_DEVICE)
@@ -441,11 +534,15 @@ static const struct kscan_driver_api kscan_charlieplex_api = {
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    BUILD_ASSERT(INST_LEN(n) <= 32, "The charlieplex driver supports at most 32 GPIOs");           \
                                                                                                    \
     static struct zmk_debounce_state kscan_charlieplex_state_##n[INST_CHARLIEPLEX_LEN(n)];         \
-    static const struct gpio_dt_spec kscan_charlieplex_cells_##n[] = {                             \
+    static struct kscan_gpio kscan_charlieplex_cells_##n[] = {                                     \
+        LISTIFY(INST_LEN(n), KSCAN_GPIO_CFG_INIT, (, ), n)};                                       \
+    static struct kscan_gpio kscan_charlieplex_inputs_##n[] = {                                    \
         LISTIFY(INST_LEN(n), KSCAN_GPIO_CFG_INIT, (, ), n)};                                       \
     static struct kscan_charlieplex_data kscan_charlieplex_data_##n = {                            \
+        .inputs = KSCAN_GPIO_LIST(kscan_charlieplex_inputs_##n),                                   \
         .charlieplex_state = kscan_charlieplex_state_##n,                                          \
     };                                                                                             \
                                                                                                    \
@@ -455,8 +552,10 @@ static const struct kscan_driver_api kscan_charlieplex_api = {
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = DT_INST_ENUM_IDX(n, debounce_algorithm),                              \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
+        .keep_alive_period_ms = DT_INST_PROP(n, keep_alive_period_ms),                             \
         COND_ANY_POLLING((.poll_period_ms = DT_INST_PROP(n, poll_period_ms), ))                    \
             COND_THIS_INTERRUPT(n, (.use_interrupt = INST_INTR_DEFINED(n), ))                      \
                 COND_THIS_INTERRUPT(n, (.interrupt = KSCAN_INTR_CFG_INIT(n), ))};                  \
@@ -16,6 +16,7 @@
 #include <zephyr/sys/util.h>
 
 #include <zmk/debounce.h>
+#include <zmk/kscan_governor.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -67,6 +68,9 @@ struct kscan_direct_data {
 #endif
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
+    /** Milliseconds between the previous scan and the current one, as counted by the debouncer. */
+    int32_t scan_period_ms;
+    struct zmk_kscan_governor governor;
     /** Current state of the inputs as an array of length config->inputs.len */
     struct zmk_debounce_state *pin_state;
 };
@@ -114,11 +118,14 @@ static void kscan_direct_irq_callback_handler(const struct device *port, struct
     struct kscan_direct_irq_callback *irq_data =
         CONTAINER_OF(cb, struct kscan_direct_irq_callback, callback);
     struct kscan_direct_data *data = irq_data->dev->data;
+    const struct kscan_direct_config *config = irq_data->dev->config;
 
     // Disable our interrupts temporarily to avoid re-entry while we scan.
     kscan_direct_interrupt_disable(data->dev);
 
+    // The interrupt fired on the change itself, so only one scan period of it has elapsed.
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
 
     k_work_reschedule(&data->work, K_NO_WAIT);
 }
@@ -149,11 +156,11 @@ static int kscan_inputs_set_flags(const struct kscan_gpio_list *inputs,
     return 0;
 }
 
-static void kscan_direct_read_continue(const struct device *dev) {
-    const struct kscan_direct_config *config = dev->config;
+static void kscan_direct_read_continue(const struct device *dev, const int32_t period_ms) {
     struct kscan_direct_data *data = dev->data;
 
-    data->scan_time += config->debounce_scan_period_ms;
+    data->scan_time += period_ms;
+    data->scan_period_ms = period_ms;
 
     k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
 }
@@ -166,7 +173,8 @@ static void kscan_direct_read_end(const struct device *dev) {
     struct kscan_direct_data *data = dev->data;
     const struct kscan_direct_config *config = dev->config;
 
-    data->scan_time += config->poll_period_ms;
+    data->scan_period_ms = zmk_kscan_governor_poll_period_ms(config->poll_period_ms);
+    data->scan_time += data->scan_period_ms;
 
     // Return to polling slowly.
     k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
@@ -189,12 +197,14 @@ static int kscan_direct_read(const struct device *dev) {
             return active;
         }
 
-        zmk_debounce_update(&data->pin_state[gpio->index], active, config->debounce_scan_period_ms,
+        zmk_debounce_update(&data->pin_state[gpio->index], active, data->scan_period_ms,
                             &config->debounce_config);
     }
 
     // Process the new state.
-    bool continue_scan = false;
+    bool any_changed = false;
+    bool any_settling = false;
+    bool any_pressed = false;
 
     for (int i = 0; i < data->inputs.len; i++) {
         const struct kscan_gpio *gpio = &data->inputs.gpios[i];
@@ -208,18 +218,28 @@ static int kscan_direct_read(const struct device *dev) {
             if (config->toggle_mode && pressed) {
                 kscan_inputs_set_flags(&data->inputs, &gpio->spec);
             }
+            any_changed = true;
         }
 
-        continue_scan = continue_scan || zmk_debounce_is_active(deb_state);
+        any_settling = any_settling || zmk_debounce_is_settling(deb_state);
+        any_pressed = any_pressed || zmk_debounce_is_pressed(deb_state);
     }
 
-    if (continue_scan) {
+    switch (zmk_kscan_governor_update(&data->governor, data->scan_time, any_changed, any_settling,
+                                      any_pressed)) {
+    case ZMK_KSCAN_GOVERNOR_BURST:
         // At least one key is pressed or the debouncer has not yet decided if
         // it is pressed. Poll quickly until everything is released.
-        kscan_direct_read_continue(dev);
-    } else {
+        kscan_direct_read_continue(dev, config->debounce_scan_period_ms);
+        break;
+    case ZMK_KSCAN_GOVERNOR_HELD:
+        // Keys are held, but none have changed for a while. Poll less often.
+        kscan_direct_read_continue(dev, zmk_kscan_governor_held_period_ms());
+        break;
+    default:
         // All keys are released. Return to normal.
         kscan_direct_read_end(dev);
+        break;
     }
 
     return 0;
@@ -244,8 +264,10 @@ static int kscan_direct_configure(const struct device *dev, kscan_callback_t cal
 
 static int kscan_direct_enable(const struct device *dev) {
     struct kscan_direct_data *data = dev->data;
+    const struct kscan_direct_config *config = dev->config;
 
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
 
     // Read will automatically start interrupts/polling once done.
     return kscan_direct_read(dev);
@@ -335,6 +357,8 @@ static int kscan_direct_init(const struct device *dev) {
     // Sort inputs by port so we can read each port just once per scan.
     kscan_gpio_list_sort_by_port(&data->inputs);
 
+    zmk_kscan_governor_init(&data->governor, dev->name);
+
     k_work_init_delayable(&data->work, kscan_direct_work_handler);
 
 #if IS_ENABLED(CONFIG_PM_DEVICE)
@@ -402,6 +426,7 @@ static const struct kscan_driver_api kscan_direct_api = {
             {                                                                                      \
                 .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
                 .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
+                .algorithm = DT_INST_ENUM_IDX(n, debounce_algorithm),                              \
             },                                                                                     \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
@@ -17,6 +17,7 @@
 #include <zephyr/sys/util.h>
 
 #include <zmk/debounce.h>
+#include <zmk/kscan_governor.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -30,6 +31,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #define INST_COLS_LEN(n) DT_INST_PROP_LEN(n, col_gpios)
 #define INST_MATRIX_LEN(n) (INST_ROWS_LEN(n) * INST_COLS_LEN(n))
 #define INST_INPUTS_LEN(n) COND_DIODE_DIR(n, (INST_COLS_LEN(n)), (INST_ROWS_LEN(n)))
+#define INST_OUTPUTS_LEN(n) COND_DIODE_DIR(n, (INST_ROWS_LEN(n)), (INST_COLS_LEN(n)))
 
 #if CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
 #define INST_DEBOUNCE_PRESS_MS(n) CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS
@@ -45,12 +47,39 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
     DT_INST_PROP_OR(n, debounce_period, DT_INST_PROP(n, debounce_release_ms))
 #endif
 
+#define INST_DEBOUNCE_CONFIG(n)                                                                    \
+    {                                                                                              \
+        .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                            \
+        .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                        \
+        .algorithm = DT_INST_ENUM_IDX(n, debounce_algorithm),                                      \
+    }
+
+#define INST_DEBOUNCE_ROW_CONFIG(n)                                                                \
+    ZMK_DEBOUNCE_ROW_CONFIG(INST_DEBOUNCE_PRESS_MS(n), INST_DEBOUNCE_RELEASE_MS(n),                \
+                            DT_INST_PROP(n, debounce_scan_period_ms))
+
+#define KSCAN_MATRIX_PORT_PARALLEL_ASSERTS(n)                                                      \
+    BUILD_ASSERT(INST_INPUTS_LEN(n) <= ZMK_DEBOUNCE_ROW_MAX_SWITCHES,                              \
+                 "CONFIG_ZMK_KSCAN_MATRIX_PORT_PARALLEL supports at most 32 inputs");              \
+    BUILD_ASSERT(ZMK_DEBOUNCE_ROW_SCANS(                                                           \
+                     MAX(INST_DEBOUNCE_PRESS_MS(n), INST_DEBOUNCE_RELEASE_MS(n)),                  \
+                     DT_INST_PROP(n, debounce_scan_period_ms)) <= ZMK_DEBOUNCE_ROW_COUNTER_MAX,    \
+                 "Debounce time is too many scan periods for port parallel scanning");             \
+    BUILD_ASSERT(DT_INST_ENUM_IDX(n, debounce_algorithm) == ZMK_DEBOUNCE_INTEGRATOR,               \
+                 "CONFIG_ZMK_KSCAN_MATRIX_PORT_PARALLEL only supports the integrator debounce "    \
+                 "algorithm");
+
 #define USE_POLLING IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_POLLING)
 #define USE_INTERRUPTS (!USE_POLLING)
 
+#define USE_PORT_PARALLEL IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_PORT_PARALLEL)
+#define USE_WALKING_STROBE IS_ENABLED(CONFIG_ZMK_KSCAN_MATRIX_WALKING_STROBE)
+
 #define COND_INTERRUPTS(code) COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_POLLING, (), code)
 #define COND_POLL_OR_INTERRUPTS(pollcode, intcode)                                                 \
     COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_POLLING, pollcode, intcode)
+#define COND_PORT_PARALLEL(parallelcode, cellcode)                                                 \
+    COND_CODE_1(CONFIG_ZMK_KSCAN_MATRIX_PORT_PARALLEL, parallelcode, cellcode)
 
 #define KSCAN_GPIO_ROW_CFG_INIT(idx, inst_idx)                                                     \
     KSCAN_GPIO_GET_BY_IDX(DT_DRV_INST(inst_idx), row_gpios, idx)
@@ -78,16 +107,31 @@ struct kscan_matrix_data {
 #endif
     /** Timestamp of the current or scheduled scan. */
     int64_t scan_time;
+    /** Milliseconds between the previous scan and the current one, as counted by the debouncer. */
+    int32_t scan_period_ms;
+    struct zmk_kscan_governor governor;
+#if USE_PORT_PARALLEL
+    /**
+     * Current state of the matrix with one entry per output, each holding one bit per input.
+     * Array of length config->outputs.len
+     */
+    struct zmk_debounce_row_state *output_state;
+#else
     /**
      * Current state of the matrix as a flattened 2D array of length
      * (config->rows * config->cols)
      */
     struct zmk_debounce_state *matrix_state;
+#endif
 };
 
 struct kscan_matrix_config {
     struct kscan_gpio_list outputs;
+#if USE_PORT_PARALLEL
+    struct zmk_debounce_row_config debounce_config;
+#else
     struct zmk_debounce_config debounce_config;
+#endif
     size_t rows;
     size_t cols;
     int32_t debounce_scan_period_ms;
@@ -95,6 +139,8 @@ struct kscan_matrix_config {
     enum kscan_diode_direction diode_direction;
 };
 
+#if !USE_PORT_PARALLEL
+
 /**
  * Get the index into a matrix state array from a row and column.
  */
@@ -115,6 +161,78 @@ static int state_index_io(const struct kscan_matrix_config *config, const int in
                : state_index_rc(config, input_idx, output_idx);
 }
 
+#endif // !USE_PORT_PARALLEL
+
+#if USE_WALKING_STROBE
+
+static int kscan_matrix_set_all_outputs(const struct device *dev, const int value) {
+    const struct kscan_matrix_config *config = dev->config;
+
+    // Write each port once, the first time one of its outputs comes up.
+    for (int i = 0; i < config->outputs.len; i++) {
+        const struct device *port = config->outputs.gpios[i].spec.port;
+        gpio_port_pins_t pins = 0;
+        bool first = true;
+
+        for (int j = 0; j < config->outputs.len; j++) {
+            const struct gpio_dt_spec *gpio = &config->outputs.gpios[j].spec;
+
+            if (gpio->port == port) {
+                first = first && j >= i;
+                pins |= BIT(gpio->pin);
+            }
+        }
+
+        if (!first) {
+            continue;
+        }
+
+        int err = gpio_port_set_masked(port, pins, value ? pins : 0);
+        if (err) {
+            LOG_ERR("Failed to set outputs on %s to %i: %i", port->name, value, err);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Set the previous output inactive and the next one active, with a single write if they are on
+ * the same port. Either may be NULL at the start or end of a scan.
+ */
+static int kscan_matrix_strobe(const struct kscan_gpio *prev, const struct kscan_gpio *next) {
+    if (prev && next && prev->spec.port == next->spec.port) {
+        const gpio_port_pins_t pins = BIT(prev->spec.pin) | BIT(next->spec.pin);
+
+        int err = gpio_port_set_masked(next->spec.port, pins, BIT(next->spec.pin));
+        if (err) {
+            LOG_ERR("Failed to move output %i to %i: %i", prev->index, next->index, err);
+        }
+        return err;
+    }
+
+    if (prev) {
+        int err = gpio_pin_set_dt(&prev->spec, 0);
+        if (err) {
+            LOG_ERR("Failed to set output %i inactive: %i", prev->index, err);
+            return err;
+        }
+    }
+
+    if (next) {
+        int err = gpio_pin_set_dt(&next->spec, 1);
+        if (err) {
+            LOG_ERR("Failed to set output %i active: %i", next->index, err);
+            return err;
+        }
+    }
+
+    return 0;
+}
+
+#else
+
 static int kscan_matrix_set_all_outputs(const struct device *dev, const int value) {
     const struct kscan_matrix_config *config = dev->config;
 
@@ -131,6 +249,8 @@ static int kscan_matrix_set_all_outputs(const struct device *dev, const int valu
     return 0;
 }
 
+#endif // USE_WALKING_STROBE
+
 #if USE_INTERRUPTS
 static int kscan_matrix_interrupt_configure(const struct device *dev, const gpio_flags_t flags) {
     const struct kscan_matrix_data *data = dev->data;
@@ -181,21 +301,24 @@ static void kscan_matrix_irq_callback_handler(const struct device *port, struct
     struct kscan_matrix_irq_callback *irq_data =
         CONTAINER_OF(cb, struct kscan_matrix_irq_callback, callback);
     struct kscan_matrix_data *data = irq_data->dev->data;
+    const struct kscan_matrix_config *config = irq_data->dev->config;
 
     // Disable our interrupts temporarily to avoid re-entry while we scan.
     kscan_matrix_interrupt_disable(data->dev);
 
+    // The interrupt fired on the change itself, so only one scan period of it has elapsed.
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
 
     k_work_reschedule(&data->work, K_NO_WAIT);
 }
 #endif
 
-static void kscan_matrix_read_continue(const struct device *dev) {
-    const struct kscan_matrix_config *config = dev->config;
+static void kscan_matrix_read_continue(const struct device *dev, const int32_t period_ms) {
     struct kscan_matrix_data *data = dev->data;
 
-    data->scan_time += config->debounce_scan_period_ms;
+    data->scan_time += period_ms;
+    data->scan_period_ms = period_ms;
 
     k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
 }
@@ -208,13 +331,116 @@ static void kscan_matrix_read_end(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
     const struct kscan_matrix_config *config = dev->config;
 
-    data->scan_time += config->poll_period_ms;
+    data->scan_period_ms = zmk_kscan_governor_poll_period_ms(config->poll_period_ms);
+    data->scan_time += data->scan_period_ms;
 
     // Return to polling slowly.
     k_work_reschedule(&data->work, K_TIMEOUT_ABS_MS(data->scan_time));
 #endif
 }
 
+static void kscan_matrix_read_next(const struct device *dev, const bool changed,
+                                   const bool settling, const bool pressed) {
+    const struct kscan_matrix_config *config = dev->config;
+    struct kscan_matrix_data *data = dev->data;
+
+    switch (
+        zmk_kscan_governor_update(&data->governor, data->scan_time, changed, settling, pressed)) {
+    case ZMK_KSCAN_GOVERNOR_BURST:
+        // At least one key is pressed or the debouncer has not yet decided if
+        // it is pressed. Poll quickly until everything is released.
+        kscan_matrix_read_continue(dev, config->debounce_scan_period_ms);
+        break;
+    case ZMK_KSCAN_GOVERNOR_HELD:
+        // Keys are held, but none have changed for a while. Poll less often.
+        kscan_matrix_read_continue(dev, zmk_kscan_governor_held_period_ms());
+        break;
+    default:
+        // All keys are released. Return to normal.
+        kscan_matrix_read_end(dev);
+        break;
+    }
+}
+
+#if USE_PORT_PARALLEL
+
+/**
+ * Report any changed keys, and schedule the next scan.
+ */
+static void kscan_matrix_process_state(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+
+    uint32_t any_changed = 0;
+    uint32_t any_settling = 0;
+    uint32_t any_pressed = 0;
+
+    for (int i = 0; i < config->outputs.len; i++) {
+        any_changed |= zmk_debounce_row_get_changed(&data->output_state[i]);
+        any_settling |= zmk_debounce_row_get_settling(&data->output_state[i]);
+        any_pressed |= zmk_debounce_row_get_pressed(&data->output_state[i]);
+    }
+
+    if (!any_changed) {
+        kscan_matrix_read_next(dev, false, any_settling != 0, any_pressed != 0);
+        return;
+    }
+
+    // Send events in the same row-major order as when debouncing each key separately.
+    for (int r = 0; r < config->rows; r++) {
+        for (int c = 0; c < config->cols; c++) {
+            const int output_idx = (config->diode_direction == KSCAN_ROW2COL) ? r : c;
+            const int input_idx = (config->diode_direction == KSCAN_ROW2COL) ? c : r;
+            const struct zmk_debounce_row_state *state = &data->output_state[output_idx];
+
+            if (zmk_debounce_row_get_changed(state) & BIT(input_idx)) {
+                const bool pressed = zmk_debounce_row_get_pressed(state) & BIT(input_idx);
+
+                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
+                data->callback(dev, r, c, pressed);
+            }
+        }
+    }
+
+    kscan_matrix_read_next(dev, true, any_settling != 0, any_pressed != 0);
+}
+
+#else
+
+/**
+ * Report any changed keys, and schedule the next scan.
+ */
+static void kscan_matrix_process_state(const struct device *dev) {
+    struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
+
+    bool any_changed = false;
+    bool any_settling = false;
+    bool any_pressed = false;
+
+    for (int r = 0; r < config->rows; r++) {
+        for (int c = 0; c < config->cols; c++) {
+            const int index = state_index_rc(config, r, c);
+            struct zmk_debounce_state *state = &data->matrix_state[index];
+
+            if (zmk_debounce_get_changed(state)) {
+                const bool pressed = zmk_debounce_is_pressed(state);
+
+                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
+                data->callback(dev, r, c, pressed);
+                any_changed = true;
+            }
+
+            any_settling = any_settling || zmk_debounce_is_settling(state);
+            any_pressed = any_pressed || zmk_debounce_is_pressed(state);
+        }
+    }
+
+    kscan_matrix_read_next(dev, any_changed, any_settling, any_pressed);
+}
+
+#endif // USE_PORT_PARALLEL
+
 static int kscan_matrix_read(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
     const struct kscan_matrix_config *config = dev->config;
@@ -223,15 +449,35 @@ static int kscan_matrix_read(const struct device *dev) {
     for (int i = 0; i < config->outputs.len; i++) {
         const struct kscan_gpio *out_gpio = &config->outputs.gpios[i];
 
+#if USE_WALKING_STROBE
+        int err = kscan_matrix_strobe(i > 0 ? &config->outputs.gpios[i - 1] : NULL, out_gpio);
+        if (err) {
+            return err;
+        }
+#else
         int err = gpio_pin_set_dt(&out_gpio->spec, 1);
         if (err) {
             LOG_ERR("Failed to set output %i active: %i", out_gpio->index, err);
             return err;
         }
+#endif
 
 #if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BEFORE_INPUTS > 0
         k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BEFORE_INPUTS);
 #endif
+#if USE_PORT_PARALLEL
+        uint32_t active;
+        err = kscan_gpio_list_get(&data->inputs, &active);
+        if (err) {
+            LOG_ERR("Failed to read inputs for output %i: %i", out_gpio->index, err);
+            return err;
+        }
+
+        // This counts scans rather than time, so a slower scan in held mode counts as a single
+        // debounce scan period, the same as without the governor.
+        zmk_debounce_row_update(&data->output_state[out_gpio->index], active,
+                                &config->debounce_config);
+#else
         struct kscan_gpio_port_state state = {0};
 
         for (int j = 0; j < data->inputs.len; j++) {
@@ -244,10 +490,12 @@ static int kscan_matrix_read(const struct device *dev) {
                 return active;
             }
 
-            zmk_debounce_update(&data->matrix_state[index], active, config->debounce_scan_period_ms,
+            zmk_debounce_update(&data->matrix_state[index], active, data->scan_period_ms,
                                 &config->debounce_config);
         }
+#endif
 
+#if !USE_WALKING_STROBE
         err = gpio_pin_set_dt(&out_gpio->spec, 0);
         if (err) {
             LOG_ERR("Failed to set output %i inactive: %i", out_gpio->index, err);
@@ -257,35 +505,20 @@ static int kscan_matrix_read(const struct device *dev) {
 #if CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS > 0
         k_busy_wait(CONFIG_ZMK_KSCAN_MATRIX_WAIT_BETWEEN_OUTPUTS);
 #endif
+#endif // !USE_WALKING_STROBE
     }
 
-    // Process the new state.
-    bool continue_scan = false;
-
-    for (int r = 0; r < config->rows; r++) {
-        for (int c = 0; c < config->cols; c++) {
-            const int index = state_index_rc(config, r, c);
-            struct zmk_debounce_state *state = &data->matrix_state[index];
-
-            if (zmk_debounce_get_changed(state)) {
-                const bool pressed = zmk_debounce_is_pressed(state);
-
-                LOG_DBG("Sending event at %i,%i state %s", r, c, pressed ? "on" : "off");
-                data->callback(dev, r, c, pressed);
-            }
-
-            continue_scan = continue_scan || zmk_debounce_is_active(state);
+#if USE_WALKING_STROBE
+    if (config->outputs.len > 0) {
+        int err = kscan_matrix_strobe(&config->outputs.gpios[config->outputs.len - 1], NULL);
+        if (err) {
+            return err;
         }
     }
+#endif
 
-    if (continue_scan) {
-        // At least one key is pressed or the debouncer has not yet decided if
-        // it is pressed. Poll quickly until everything is released.
-        kscan_matrix_read_continue(dev);
-    } else {
-        // All keys are released. Return to normal.
-        kscan_matrix_read_end(dev);
-    }
+    // Process the new state.
+    kscan_matrix_process_state(dev);
 
     return 0;
 }
@@ -309,8 +542,10 @@ static int kscan_matrix_configure(const struct device *dev, const kscan_callback
 
 static int kscan_matrix_enable(const struct device *dev) {
     struct kscan_matrix_data *data = dev->data;
+    const struct kscan_matrix_config *config = dev->config;
 
     data->scan_time = k_uptime_get();
+    data->scan_period_ms = config->debounce_scan_period_ms;
 
     // Read will automatically start interrupts/polling once done.
     return kscan_matrix_read(dev);
@@ -451,6 +686,8 @@ static int kscan_matrix_init(const struct device *dev) {
     // Sort inputs by port so we can read each port just once per scan.
     kscan_gpio_list_sort_by_port(&data->inputs);
 
+    zmk_kscan_governor_init(&data->governor, dev->name);
+
     k_work_init_delayable(&data->work, kscan_matrix_work_handler);
 
 #if IS_ENABLED(CONFIG_PM_DEVICE)
@@ -497,6 +734,7 @@ static const struct kscan_driver_api kscan_matrix_api = {
                  "ZMK_KSCAN_DEBOUNCE_PRESS_MS or debounce-press-ms is too large");                 \
     BUILD_ASSERT(INST_DEBOUNCE_RELEASE_MS(n) <= DEBOUNCE_COUNTER_MAX,                              \
                  "ZMK_KSCAN_DEBOUNCE_RELEASE_MS or debounce-release-ms is too large");             \
+    COND_PORT_PARALLEL((KSCAN_MATRIX_PORT_PARALLEL_ASSERTS(n)), ())                                \
                                                                                                    \
     static struct kscan_gpio kscan_matrix_rows_##n[] = {                                           \
         LISTIFY(INST_ROWS_LEN(n), KSCAN_GPIO_ROW_CFG_INIT, (, ), n)};                              \
@@ -504,7 +742,9 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_gpio kscan_matrix_cols_##n[] = {                                           \
         LISTIFY(INST_COLS_LEN(n), KSCAN_GPIO_COL_CFG_INIT, (, ), n)};                              \
                                                                                                    \
-    static struct zmk_debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];                   \
+    COND_PORT_PARALLEL(                                                                            \
+        (static struct zmk_debounce_row_state kscan_matrix_state_##n[INST_OUTPUTS_LEN(n)];),       \
+        (static struct zmk_debounce_state kscan_matrix_state_##n[INST_MATRIX_LEN(n)];))            \
                                                                                                    \
     COND_INTERRUPTS(                                                                               \
         (static struct kscan_matrix_irq_callback kscan_matrix_irqs_##n[INST_INPUTS_LEN(n)];))      \
@@ -512,7 +752,8 @@ static const struct kscan_driver_api kscan_matrix_api = {
     static struct kscan_matrix_data kscan_matrix_data_##n = {                                      \
         .inputs =                                                                                  \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_cols_##n), (kscan_matrix_rows_##n))),  \
-        .matrix_state = kscan_matrix_state_##n,                                                    \
+        COND_PORT_PARALLEL((.output_state = kscan_matrix_state_##n, ),                             \
+                           (.matrix_state = kscan_matrix_state_##n, ))                             \
         COND_INTERRUPTS((.irqs = kscan_matrix_irqs_##n, ))};                                       \
                                                                                                    \
     static const struct kscan_matrix_config kscan_matrix_config_##n = {                            \
@@ -520,11 +761,8 @@ static const struct kscan_driver_api kscan_matrix_api = {
         .cols = ARRAY_SIZE(kscan_matrix_cols_##n),                                                 \
         .outputs =                                                                                 \
             KSCAN_GPIO_LIST(COND_DIODE_DIR(n, (kscan_matrix_rows_##n), (kscan_matrix_cols_##n))),  \
-        .debounce_config =                                                                         \
-            {                                                                                      \
-                .debounce_press_ms = INST_DEBOUNCE_PRESS_MS(n),                                    \
-                .debounce_release_ms = INST_DEBOUNCE_RELEASE_MS(n),                                \
-            },                                                                                     \
+        .debounce_config = COND_PORT_PARALLEL((INST_DEBOUNCE_ROW_CONFIG(n)),                       \
+                                              (INST_DEBOUNCE_CONFIG(n))),                          \
         .debounce_scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                       \
         .poll_period_ms = DT_INST_PROP(n, poll_period_ms),                                         \
         .diode_direction = INST_DIODE_DIR(n),                                                      \
@@ -15,6 +15,7 @@
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <dt-bindings/zmk/kscan_mock.h>
+#include <zmk/debounce.h>
 
 struct kscan_mock_data {
     kscan_callback_t callback;
@@ -22,6 +23,23 @@ struct kscan_mock_data {
     uint32_t event_index;
     struct k_work_delayable work;
     const struct device *dev;
+
+    // Simulated time of the last scan and the next event, for debounced mocks.
+    uint32_t now_ms;
+    uint32_t next_event_ms;
+};
+
+struct kscan_mock_key {
+    bool active;
+    struct zmk_debounce_state state;
+};
+
+struct kscan_mock_debounce {
+    struct zmk_debounce_config config;
+    uint32_t scan_period_ms;
+    uint8_t rows;
+    uint8_t columns;
+    struct kscan_mock_key *keys;
 };
 
 static int kscan_mock_disable_callback(const struct device *dev) {
@@ -44,11 +62,97 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
     return 0;
 }
 
+/**
+ * Runs one scan of a mock with a debounce-algorithm, whose events are raw switch readings, like a
+ * bounce trace. Each event's time is counted in scans, so the result doesn't depend on how the
+ * scan work and event timing line up.
+ *
+ * @returns false once the last event's delay has passed.
+ */
+static bool kscan_mock_debounced_scan(const struct device *dev, const uint32_t *events,
+                                      size_t len, const struct kscan_mock_debounce *debounce) {
+    struct kscan_mock_data *data = dev->data;
+
+    data->now_ms += debounce->scan_period_ms;
+
+    while (data->event_index < len && data->next_event_ms <= data->now_ms) {
+        uint32_t ev = events[data->event_index++];
+
+        data->next_event_ms += ZMK_MOCK_MSEC(ev);
+
+        if (ZMK_MOCK_ROW(ev) >= debounce->rows || ZMK_MOCK_COL(ev) >= debounce->columns) {
+            LOG_ERR("Mock event row %d column %d is outside the matrix", ZMK_MOCK_ROW(ev),
+                    ZMK_MOCK_COL(ev));
+            continue;
+        }
+
+        LOG_DBG("raw row %d column %d state %d", ZMK_MOCK_ROW(ev), ZMK_MOCK_COL(ev),
+                ZMK_MOCK_IS_PRESS(ev));
+        debounce->keys[ZMK_MOCK_ROW(ev) * debounce->columns + ZMK_MOCK_COL(ev)].active =
+            ZMK_MOCK_IS_PRESS(ev);
+    }
+
+    for (int r = 0; r < debounce->rows; r++) {
+        for (int c = 0; c < debounce->columns; c++) {
+            struct kscan_mock_key *key = &debounce->keys[r * debounce->columns + c];
+
+            zmk_debounce_update(&key->state, key->active, debounce->scan_period_ms,
+                                &debounce->config);
+
+            if (zmk_debounce_get_changed(&key->state)) {
+                // Compared with the times in the trace, this shows the latency each algorithm adds.
+                LOG_DBG("row %d column %d state %d at %u ms", r, c,
+                        zmk_debounce_is_pressed(&key->state), data->now_ms);
+                data->callback(dev, r, c, zmk_debounce_is_pressed(&key->state));
+            }
+        }
+    }
+
+    return data->event_index < len || data->now_ms < data->next_event_ms;
+}
+
+#define MOCK_DEBOUNCED(n) DT_INST_NODE_HAS_PROP(n, debounce_algorithm)
+
+#define MOCK_DEBOUNCE_INIT(n)                                                                      \
+    static struct kscan_mock_key kscan_mock_keys_##n[DT_INST_PROP(n, rows) *                       \
+                                                     DT_INST_PROP(n, columns)];                    \
+    static const struct kscan_mock_debounce kscan_mock_debounce_##n = {                            \
+        .config =                                                                                  \
+            {                                                                                      \
+                .debounce_press_ms = DT_INST_PROP(n, debounce_press_ms),                           \
+                .debounce_release_ms = DT_INST_PROP(n, debounce_release_ms),                       \
+                .algorithm = DT_INST_ENUM_IDX(n, debounce_algorithm),                              \
+            },                                                                                     \
+        .scan_period_ms = DT_INST_PROP(n, debounce_scan_period_ms),                                \
+        .rows = DT_INST_PROP(n, rows),                                                             \
+        .columns = DT_INST_PROP(n, columns),                                                       \
+        .keys = kscan_mock_keys_##n,                                                               \
+    };                                                                                             \
+    static void kscan_mock_start_scan_##n(const struct device *dev) {                              \
+        struct kscan_mock_data *data = dev->data;                                                  \
+        const struct kscan_mock_config_##n *cfg = dev->config;                                     \
+        data->now_ms = 0;                                                                          \
+        data->next_event_ms = ZMK_MOCK_MSEC(cfg->events[0]);                                       \
+        k_work_schedule(&data->work, K_MSEC(kscan_mock_debounce_##n.scan_period_ms));              \
+    }                                                                                              \
+    static void kscan_mock_scan_##n(const struct device *dev) {                                    \
+        struct kscan_mock_data *data = dev->data;                                                  \
+        const struct kscan_mock_config_##n *cfg = dev->config;                                     \
+        if (kscan_mock_debounced_scan(dev, cfg->events, DT_INST_PROP_LEN(n, events),               \
+                                      &kscan_mock_debounce_##n)) {                                 \
+            k_work_schedule(&data->work, K_MSEC(kscan_mock_debounce_##n.scan_period_ms));          \
+        } else if (cfg->exit_after) {                                                              \
+            LOG_DBG("Exiting");                                                                    \
+            exit(0);                                                                               \
+        }                                                                                          \
+    }
+
 #define MOCK_INST_INIT(n)                                                                          \
     struct kscan_mock_config_##n {                                                                 \
         uint32_t events[DT_INST_PROP_LEN(n, events)];                                              \
         bool exit_after;                                                                           \
     };                                                                                             \
+    COND_CODE_1(MOCK_DEBOUNCED(n), (MOCK_DEBOUNCE_INIT(n)), ())                                    \
     static void kscan_mock_schedule_next_event_##n(const struct device *dev) {                     \
         struct kscan_mock_data *data = dev->data;                                                  \
         const struct kscan_mock_config_##n *cfg = dev->config;                                     \
@@ -65,6 +169,7 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         struct k_work_delayable *d_work = k_work_delayable_from_work(work);                        \
         struct kscan_mock_data *data = CONTAINER_OF(d_work, struct kscan_mock_data, work);         \
         const struct kscan_mock_config_##n *cfg = data->dev->config;                               \
+        COND_CODE_1(MOCK_DEBOUNCED(n), (kscan_mock_scan_##n(data->dev); return;), ())              \
         if (data->event_index >= DT_INST_PROP_LEN(n, events)) {                                    \
             if (cfg->exit_after)                                                                   \
                 exit(0);                                                                           \
@@ -85,7 +190,8 @@ static int kscan_mock_configure(const struct device *dev, kscan_callback_t callb
         return 0;                                                                                  \
     }                                                                                              \
     static int kscan_mock_enable_callback_##n(const struct device *dev) {                          \
-        kscan_mock_schedule_next_event_##n(dev);                                                   \
+        COND_CODE_1(MOCK_DEBOUNCED(n), (kscan_mock_start_scan_##n(dev)),                           \
+                    (kscan_mock_schedule_next_event_##n(dev)));                                    \
         return 0;                                                                                  \
     }                                                                                              \
     static const struct kscan_driver_api mock_driver_api_##n = {                                   \
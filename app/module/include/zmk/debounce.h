@@ -19,11 +19,38 @@ struct zmk_debounce_state {
     uint16_t counter : DEBOUNCE_COUNTER_BITS;
 };
 
+/**
+ * Debounce algorithms, in the same order as the debounce-algorithm devicetree property.
+ */
+enum zmk_debounce_algorithm {
+    /**
+     * Count up while the switch reads differently from its latched state and down while it
+     * matches, and latch the new state once the count reaches the debounce time.
+     */
+    ZMK_DEBOUNCE_INTEGRATOR,
+    /**
+     * Latch a press as soon as it is read. Latch a release once the switch has read as released
+     * for the release debounce time without interruption.
+     */
+    ZMK_DEBOUNCE_EAGER_PRESS,
+    /**
+     * Latch either change once the switch has read the new state for the debounce time without
+     * interruption.
+     */
+    ZMK_DEBOUNCE_DEFER,
+    /**
+     * Latch either change as soon as it is read, then ignore the switch for the debounce time of
+     * the new state.
+     */
+    ZMK_DEBOUNCE_LOCKOUT,
+};
+
 struct zmk_debounce_config {
     /** Duration a switch must be pressed to latch as pressed. */
     uint32_t debounce_press_ms;
     /** Duration a switch must be released to latch as released. */
     uint32_t debounce_release_ms;
+    enum zmk_debounce_algorithm algorithm;
 };
 
 /**
@@ -44,6 +71,13 @@ void zmk_debounce_update(struct zmk_debounce_state *state, const bool active, co
  */
 bool zmk_debounce_is_active(const struct zmk_debounce_state *state);
 
+/**
+ * @returns whether the debouncer is partway through counting for the switch, either towards
+ * latching a new state or back down after a bounce. If this returns false, the switch can only
+ * change state once it reads differently from its latched state.
+ */
+bool zmk_debounce_is_settling(const struct zmk_debounce_state *state);
+
 /**
  * @returns whether the switch is latched as pressed.
  */
@@ -54,3 +88,92 @@ bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state);
  * debounce_update.
  */
 bool zmk_debounce_get_changed(const struct zmk_debounce_state *state);
+
+#if IS_ENABLED(CONFIG_ZMK_DEBOUNCE_ROW)
+
+#define ZMK_DEBOUNCE_ROW_MAX_SWITCHES 32
+#define ZMK_DEBOUNCE_ROW_COUNTER_BITS 8
+#define ZMK_DEBOUNCE_ROW_COUNTER_MAX BIT_MASK(ZMK_DEBOUNCE_ROW_COUNTER_BITS)
+
+/** Number of scans a switch must stay in a new state for to latch, given the debounce time. */
+#define ZMK_DEBOUNCE_ROW_SCANS(ms, scan_period_ms) DIV_ROUND_UP(ms, MAX(scan_period_ms, 1))
+
+/** Number of counter bits needed to count up to @p v, which must be at most 255. */
+#define ZMK_DEBOUNCE_ROW_BITS_FOR(v)                                                               \
+    (1 + ((v) >= 2) + ((v) >= 4) + ((v) >= 8) + ((v) >= 16) + ((v) >= 32) + ((v) >= 64) +         \
+     ((v) >= 128))
+
+/**
+ * Initializer for a struct zmk_debounce_row_config from debounce times in milliseconds.
+ */
+#define ZMK_DEBOUNCE_ROW_CONFIG(press_ms, release_ms, scan_period_ms)                              \
+    {                                                                                              \
+        .debounce_press_scans = ZMK_DEBOUNCE_ROW_SCANS(press_ms, scan_period_ms),                  \
+        .debounce_release_scans = ZMK_DEBOUNCE_ROW_SCANS(release_ms, scan_period_ms),              \
+        .counter_bits = ZMK_DEBOUNCE_ROW_BITS_FOR(                                                 \
+            MAX(ZMK_DEBOUNCE_ROW_SCANS(press_ms, scan_period_ms),                                  \
+                ZMK_DEBOUNCE_ROW_SCANS(release_ms, scan_period_ms))),                              \
+    }
+
+/**
+ * Debounce state for up to 32 switches which are always read together, such as the switches on
+ * one output of a matrix. Bit N of each field belongs to switch N.
+ *
+ * The counters are bit-sliced: bit N of counter[B] is bit B of switch N's counter, so every switch
+ * is updated at once with a few operations per counter bit.
+ */
+struct zmk_debounce_row_state {
+    uint32_t pressed;
+    uint32_t changed;
+    uint32_t counter[ZMK_DEBOUNCE_ROW_COUNTER_BITS];
+};
+
+struct zmk_debounce_row_config {
+    /** Number of scans a switch must be pressed to latch as pressed. */
+    uint8_t debounce_press_scans;
+    /** Number of scans a switch must be released to latch as released. */
+    uint8_t debounce_release_scans;
+    /** Number of counter bits needed to count up to either number of scans. */
+    uint8_t counter_bits;
+};
+
+/**
+ * Debounces a row of switches.
+ *
+ * This behaves the same as calling zmk_debounce_update() for each switch with an elapsed time of
+ * one scan period, but counts in scans instead of milliseconds.
+ *
+ * @param state The state for the switches to debounce.
+ * @param active Bitmask of the switches which are currently pressed.
+ * @param config Debounce settings.
+ */
+void zmk_debounce_row_update(struct zmk_debounce_row_state *state, const uint32_t active,
+                             const struct zmk_debounce_row_config *config);
+
+/**
+ * @returns a bitmask of the switches which are either latched as pressed or potentially pressed
+ * but not yet decided. If this is non-zero, the kscan driver should continue to poll quickly.
+ */
+uint32_t zmk_debounce_row_get_active(const struct zmk_debounce_row_state *state);
+
+/**
+ * @returns a bitmask of the switches for which zmk_debounce_is_settling() would return true.
+ */
+uint32_t zmk_debounce_row_get_settling(const struct zmk_debounce_row_state *state);
+
+/**
+ * @returns a bitmask of the switches latched as pressed.
+ */
+static inline uint32_t zmk_debounce_row_get_pressed(const struct zmk_debounce_row_state *state) {
+    return state->pressed;
+}
+
+/**
+ * @returns a bitmask of the switches whose pressed state changed in the last call to
+ * zmk_debounce_row_update().
+ */
+static inline uint32_t zmk_debounce_row_get_changed(const struct zmk_debounce_row_state *state) {
+    return state->changed;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_DEBOUNCE_ROW)
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+
+enum zmk_kscan_governor_mode {
+    /** Keys are changing, or changed recently. Scan every debounce scan period. */
+    ZMK_KSCAN_GOVERNOR_BURST,
+    /** Keys are held, but none have changed for a while. Scan at the held scan period. */
+    ZMK_KSCAN_GOVERNOR_HELD,
+    /** No keys are pressed. Wait for an interrupt, or poll at the poll period. */
+    ZMK_KSCAN_GOVERNOR_IDLE,
+
+    ZMK_KSCAN_GOVERNOR_MODE_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_GOVERNOR)
+
+/**
+ * Scan rate state for one keyboard scan driver instance.
+ */
+struct zmk_kscan_governor {
+    sys_snode_t node;
+    const char *name;
+    enum zmk_kscan_governor_mode mode;
+    /** Timestamp of the last scan which saw a key change or settling. */
+    int64_t last_change;
+    /** Timestamp of the switch to the current mode. */
+    int64_t mode_since;
+    /** Milliseconds spent in each mode before the current one. */
+    int64_t mode_time_ms[ZMK_KSCAN_GOVERNOR_MODE_COUNT];
+};
+
+/**
+ * Set up a governor and register it for statistics reporting.
+ *
+ * @param name The name to report statistics under, usually the driver's device name.
+ */
+void zmk_kscan_governor_init(struct zmk_kscan_governor *gov, const char *name);
+
+/**
+ * Pick how a driver should schedule its next scan.
+ *
+ * @param scan_time Timestamp of the scan which was just completed.
+ * @param changed Whether the scan reported any key as pressed or released.
+ * @param settling Whether the debouncer has not decided on the state of any key.
+ * @param pressed Whether any key is latched as pressed.
+ */
+enum zmk_kscan_governor_mode zmk_kscan_governor_update(struct zmk_kscan_governor *gov,
+                                                       int64_t scan_time, bool changed,
+                                                       bool settling, bool pressed);
+
+/**
+ * @returns the time between scans in milliseconds in ZMK_KSCAN_GOVERNOR_HELD mode.
+ */
+static inline int32_t zmk_kscan_governor_held_period_ms(void) {
+    return CONFIG_ZMK_KSCAN_GOVERNOR_HELD_PERIOD_MS;
+}
+
+/**
+ * @returns the time between polls in milliseconds in ZMK_KSCAN_GOVERNOR_IDLE mode, for a driver
+ * which polls every @p poll_period_ms normally.
+ */
+int32_t zmk_kscan_governor_poll_period_ms(int32_t poll_period_ms);
+
+/**
+ * Tell the governors whether the keyboard is idle, which allows polling drivers to poll slower.
+ */
+void zmk_kscan_governor_set_idle(bool idle);
+
+#else
+
+struct zmk_kscan_governor {};
+
+static inline void zmk_kscan_governor_init(struct zmk_kscan_governor *gov, const char *name) {}
+
+static inline enum zmk_kscan_governor_mode
+zmk_kscan_governor_update(struct zmk_kscan_governor *gov, int64_t scan_time, bool changed,
+                          bool settling, bool pressed) {
+    // Scan quickly until every key is released, as drivers did before the governor.
+    return (settling || pressed) ? ZMK_KSCAN_GOVERNOR_BURST : ZMK_KSCAN_GOVERNOR_IDLE;
+}
+
+static inline int32_t zmk_kscan_governor_held_period_ms(void) { return 0; }
+
+static inline int32_t zmk_kscan_governor_poll_period_ms(int32_t poll_period_ms) {
+    return poll_period_ms;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_GOVERNOR)
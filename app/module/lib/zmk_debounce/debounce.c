@@ -27,15 +27,19 @@ static void decrement_counter(struct zmk_debounce_state *state, const int elapse
     }
 }
 
-void zmk_debounce_update(struct zmk_debounce_state *state, const bool active, const int elapsed_ms,
-                         const struct zmk_debounce_config *config) {
+static void flip(struct zmk_debounce_state *state) {
+    state->pressed = !state->pressed;
+    state->counter = 0;
+    state->changed = true;
+}
+
+static void update_integrator(struct zmk_debounce_state *state, const bool active,
+                              const int elapsed_ms, const struct zmk_debounce_config *config) {
     // This uses a variation of the integrator debouncing described at
     // https://www.kennethkuhn.com/electronics/debounce.c
     // Every update where "active" does not match the current state, we increment
     // a counter, otherwise we decrement it. When the counter reaches a
     // threshold, the state flips and we reset the counter.
-    state->changed = false;
-
     if (active == state->pressed) {
         decrement_counter(state, elapsed_ms);
         return;
@@ -48,15 +52,69 @@ void zmk_debounce_update(struct zmk_debounce_state *state, const bool active, co
         return;
     }
 
-    state->pressed = !state->pressed;
-    state->counter = 0;
-    state->changed = true;
+    flip(state);
+}
+
+static void update_defer(struct zmk_debounce_state *state, const bool active,
+                         const int elapsed_ms, const uint32_t flip_threshold) {
+    // The same as the integrator, except that a single read matching the current state starts
+    // the count again from zero.
+    if (active == state->pressed) {
+        state->counter = 0;
+        return;
+    }
+
+    if (state->counter < flip_threshold) {
+        increment_counter(state, elapsed_ms);
+        return;
+    }
+
+    flip(state);
+}
+
+static void update_lockout(struct zmk_debounce_state *state, const bool active,
+                           const int elapsed_ms, const struct zmk_debounce_config *config) {
+    // The counter holds the remaining lockout time after a change.
+    if (state->counter > 0) {
+        decrement_counter(state, elapsed_ms);
+        return;
+    }
+
+    if (active != state->pressed) {
+        // Lock out for the debounce time of the change which was just latched.
+        const uint32_t lockout_ms = get_threshold(state, config);
+
+        flip(state);
+        state->counter = MIN(lockout_ms, DEBOUNCE_COUNTER_MAX);
+    }
+}
+
+void zmk_debounce_update(struct zmk_debounce_state *state, const bool active, const int elapsed_ms,
+                         const struct zmk_debounce_config *config) {
+    state->changed = false;
+
+    switch (config->algorithm) {
+    case ZMK_DEBOUNCE_EAGER_PRESS:
+        update_defer(state, active, elapsed_ms, state->pressed ? config->debounce_release_ms : 0);
+        break;
+    case ZMK_DEBOUNCE_DEFER:
+        update_defer(state, active, elapsed_ms, get_threshold(state, config));
+        break;
+    case ZMK_DEBOUNCE_LOCKOUT:
+        update_lockout(state, active, elapsed_ms, config);
+        break;
+    default:
+        update_integrator(state, active, elapsed_ms, config);
+        break;
+    }
 }
 
 bool zmk_debounce_is_active(const struct zmk_debounce_state *state) {
     return state->pressed || state->counter > 0;
 }
 
+bool zmk_debounce_is_settling(const struct zmk_debounce_state *state) { return state->counter > 0; }
+
 bool zmk_debounce_is_pressed(const struct zmk_debounce_state *state) { return state->pressed; }
 
 bool zmk_debounce_get_changed(const struct zmk_debounce_state *state) { return state->changed; }
\ No newline at end of file
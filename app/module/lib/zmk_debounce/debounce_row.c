@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zmk/debounce.h>
+
+/**
+ * @returns a bitmask of the switches whose counter is at least @p value.
+ */
+static uint32_t counter_at_least(const struct zmk_debounce_row_state *state, const uint8_t bits,
+                                 const uint32_t value) {
+    // Compare from the most significant bit down. A switch is greater once one of its bits is set
+    // where the value's is clear, with all higher bits being equal.
+    uint32_t greater = 0;
+    uint32_t equal = UINT32_MAX;
+
+    for (int b = bits - 1; b >= 0; b--) {
+        if (value & BIT(b)) {
+            equal &= state->counter[b];
+        } else {
+            greater |= equal & state->counter[b];
+            equal &= ~state->counter[b];
+        }
+    }
+
+    return greater | equal;
+}
+
+static uint32_t counter_nonzero(const struct zmk_debounce_row_state *state, const uint8_t bits) {
+    uint32_t nonzero = 0;
+
+    for (int b = 0; b < bits; b++) {
+        nonzero |= state->counter[b];
+    }
+
+    return nonzero;
+}
+
+void zmk_debounce_row_update(struct zmk_debounce_row_state *state, const uint32_t active,
+                             const struct zmk_debounce_row_config *config) {
+    // This is the same integrator as zmk_debounce_update(), applied to every switch at once.
+    // Switches which don't match their latched state count up until they reach the threshold for
+    // that state, and then flip on the next update. Switches which match count back down to zero.
+    const uint8_t bits = config->counter_bits;
+    const uint32_t mismatched = active ^ state->pressed;
+    const uint32_t reached =
+        (state->pressed & counter_at_least(state, bits, config->debounce_release_scans)) |
+        (~state->pressed & counter_at_least(state, bits, config->debounce_press_scans));
+
+    const uint32_t flip = mismatched & reached;
+    uint32_t carry = mismatched & ~reached;
+    uint32_t borrow = ~mismatched & counter_nonzero(state, bits);
+
+    // Counting up stops at the threshold, so the counters can't overflow. The carries and borrows
+    // never overlap, so both can ripple through the same pass.
+    for (int b = 0; b < bits; b++) {
+        const uint32_t plane = state->counter[b];
+
+        state->counter[b] = (plane ^ carry ^ borrow) & ~flip;
+        carry &= plane;
+        borrow &= ~plane;
+    }
+
+    state->pressed ^= flip;
+    state->changed = flip;
+}
+
+uint32_t zmk_debounce_row_get_active(const struct zmk_debounce_row_state *state) {
+    return state->pressed | counter_nonzero(state, ZMK_DEBOUNCE_ROW_COUNTER_BITS);
+}
+
+uint32_t zmk_debounce_row_get_settling(const struct zmk_debounce_row_state *state) {
+    return counter_nonzero(state, ZMK_DEBOUNCE_ROW_COUNTER_BITS);
+}
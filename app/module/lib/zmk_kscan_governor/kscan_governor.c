@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include <zmk/kscan_governor.h>
+
+static sys_slist_t governors = SYS_SLIST_STATIC_INIT(&governors);
+static struct k_spinlock lock;
+static bool keyboard_idle;
+
+static void set_mode(struct zmk_kscan_governor *gov, enum zmk_kscan_governor_mode mode,
+                     int64_t timestamp) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    gov->mode_time_ms[gov->mode] += MAX(timestamp - gov->mode_since, 0);
+    gov->mode_since = timestamp;
+    gov->mode = mode;
+
+    k_spin_unlock(&lock, key);
+}
+
+void zmk_kscan_governor_init(struct zmk_kscan_governor *gov, const char *name) {
+    gov->name = name;
+    gov->mode = ZMK_KSCAN_GOVERNOR_IDLE;
+    gov->last_change = 0;
+    gov->mode_since = k_uptime_get();
+
+    for (int i = 0; i < ZMK_KSCAN_GOVERNOR_MODE_COUNT; i++) {
+        gov->mode_time_ms[i] = 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    sys_slist_append(&governors, &gov->node);
+    k_spin_unlock(&lock, key);
+}
+
+enum zmk_kscan_governor_mode zmk_kscan_governor_update(struct zmk_kscan_governor *gov,
+                                                       int64_t scan_time, bool changed,
+                                                       bool settling, bool pressed) {
+    enum zmk_kscan_governor_mode mode;
+
+    if (changed || settling) {
+        gov->last_change = scan_time;
+    }
+
+    if (settling) {
+        // The debouncer needs every scan to decide.
+        mode = ZMK_KSCAN_GOVERNOR_BURST;
+    } else if (pressed) {
+        // Keep scanning quickly while typing, so the next key is seen as soon as it is pressed.
+        mode = scan_time - gov->last_change < CONFIG_ZMK_KSCAN_GOVERNOR_BURST_MS
+                   ? ZMK_KSCAN_GOVERNOR_BURST
+                   : ZMK_KSCAN_GOVERNOR_HELD;
+    } else {
+        mode = ZMK_KSCAN_GOVERNOR_IDLE;
+    }
+
+    if (mode != gov->mode) {
+        set_mode(gov, mode, scan_time);
+    }
+
+    return mode;
+}
+
+int32_t zmk_kscan_governor_poll_period_ms(int32_t poll_period_ms) {
+    if (keyboard_idle) {
+        return MAX(poll_period_ms, CONFIG_ZMK_KSCAN_GOVERNOR_IDLE_POLL_PERIOD_MS);
+    }
+
+    return poll_period_ms;
+}
+
+void zmk_kscan_governor_set_idle(bool idle) { keyboard_idle = idle; }
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static const char *const mode_names[] = {
+    [ZMK_KSCAN_GOVERNOR_BURST] = "burst",
+    [ZMK_KSCAN_GOVERNOR_HELD] = "held",
+    [ZMK_KSCAN_GOVERNOR_IDLE] = "idle",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(mode_names) == ZMK_KSCAN_GOVERNOR_MODE_COUNT);
+
+static int cmd_kscan_gov_show(const struct shell *sh, size_t argc, char **argv) {
+    const int64_t now = k_uptime_get();
+    struct zmk_kscan_governor *gov;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&governors, gov, node) {
+        int64_t mode_time_ms[ZMK_KSCAN_GOVERNOR_MODE_COUNT];
+        int64_t total_ms = 0;
+
+        k_spinlock_key_t key = k_spin_lock(&lock);
+
+        for (int i = 0; i < ZMK_KSCAN_GOVERNOR_MODE_COUNT; i++) {
+            mode_time_ms[i] = gov->mode_time_ms[i];
+        }
+        mode_time_ms[gov->mode] += MAX(now - gov->mode_since, 0);
+
+        k_spin_unlock(&lock, key);
+
+        shell_print(sh, "%s: now %s", gov->name, mode_names[gov->mode]);
+
+        for (int i = 0; i < ZMK_KSCAN_GOVERNOR_MODE_COUNT; i++) {
+            total_ms += mode_time_ms[i];
+        }
+
+        for (int i = 0; i < ZMK_KSCAN_GOVERNOR_MODE_COUNT; i++) {
+            const uint32_t permille = total_ms ? (mode_time_ms[i] * 1000) / total_ms : 0;
+
+            shell_print(sh, "  %-6s %10lld ms %3u.%u%%", mode_names[i], mode_time_ms[i],
+                        permille / 10, permille % 10);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_kscan_gov_reset(const struct shell *sh, size_t argc, char **argv) {
+    const int64_t now = k_uptime_get();
+    struct zmk_kscan_governor *gov;
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&governors, gov, node) {
+        for (int i = 0; i < ZMK_KSCAN_GOVERNOR_MODE_COUNT; i++) {
+            gov->mode_time_ms[i] = 0;
+        }
+        gov->mode_since = now;
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_kscan_gov,
+                               SHELL_CMD(show, NULL, "Show time spent in each scan mode",
+                                         cmd_kscan_gov_show),
+                               SHELL_CMD(reset, NULL, "Clear the scan mode times",
+                                         cmd_kscan_gov_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(kscan_gov, &sub_kscan_gov, "Keyboard scan governor statistics", NULL);
+
+#endif // IS_ENABLED(CONFIG_SHELL)
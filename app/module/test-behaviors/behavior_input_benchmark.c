@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_input_benchmark
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/input/input.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <drivers/behavior.h>
+
+#include <zmk/behavior.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+#if IS_ENABLED(CONFIG_NATIVE_LIBRARY)
+
+// Implemented on the host side in behavior_input_benchmark_bottom.c. The simulated kernel clock
+// doesn't advance while the CPU is busy, so only host time can measure the work.
+uint64_t input_benchmark_host_cpu_time_ns(void);
+
+static uint64_t now_ns(void) { return input_benchmark_host_cpu_time_ns(); }
+
+#else
+
+static uint64_t now_ns(void) { return k_cyc_to_ns_floor64(k_cycle_get_64()); }
+
+#endif
+
+// Debug logs from the processors would dominate the measurement, so they are filtered out while
+// the events run.
+static void set_log_level(uint32_t level) {
+#if IS_ENABLED(CONFIG_LOG_RUNTIME_FILTERING)
+    int source_id = log_source_id_get("zmk");
+
+    if (source_id >= 0) {
+        log_filter_set(NULL, Z_LOG_LOCAL_DOMAIN_ID, source_id, level);
+    }
+#endif
+}
+
+// Hands the event to the listeners of the device the way input_report() does, but without the
+// input thread so the time spent in the listeners can be measured.
+static void report(const struct device *dev, uint16_t code, int32_t value, bool sync) {
+    struct input_event evt = {
+        .dev = dev,
+        .type = INPUT_EV_REL,
+        .code = code,
+        .value = value,
+        .sync = sync,
+    };
+
+    STRUCT_SECTION_FOREACH(input_callback, callback) {
+        if (callback->dev == NULL || callback->dev == dev) {
+            callback->callback(&evt, callback->user_data);
+        }
+    }
+}
+
+static int on_input_benchmark_binding_pressed(struct zmk_behavior_binding *binding,
+                                              struct zmk_behavior_binding_event event) {
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
+    uint32_t count = binding->param1;
+
+    if (!dev || count == 0) {
+        return -EINVAL;
+    }
+
+    set_log_level(LOG_LEVEL_INF);
+
+    uint64_t start = now_ns();
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (i & 1) {
+            report(dev, INPUT_REL_Y, -2, false);
+        } else {
+            report(dev, INPUT_REL_X, 3, false);
+        }
+    }
+
+    uint64_t elapsed = now_ns() - start;
+
+    set_log_level(LOG_LEVEL_DBG);
+
+    // Sync outside of the timed loop so the sum of the movement shows up in the HID logs.
+    report(dev, INPUT_REL_X, 0, true);
+
+    LOG_INF("Processed %u input events in %llu ns, %llu ns per event", count, elapsed,
+            elapsed / count);
+
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_input_benchmark_binding_released(struct zmk_behavior_binding *binding,
+                                               struct zmk_behavior_binding_event event) {
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static const struct behavior_driver_api behavior_input_benchmark_driver_api = {
+    .binding_pressed = on_input_benchmark_binding_pressed,
+    .binding_released = on_input_benchmark_binding_released};
+
+BEHAVIOR_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+                        &behavior_input_benchmark_driver_api);
+
+#endif // DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_keymap_settings
+
+#include <stdio.h>
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <drivers/behavior.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/keymap.h>
+#include <zmk/behavior.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE) && DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+#define KEYMAP_SETTINGS_SAVE 0
+#define KEYMAP_SETTINGS_DISCARD 1
+#define KEYMAP_SETTINGS_WRITE_LEGACY 2
+
+// Saves a binding on layer 0 the way firmware from before layer settings entries did.
+static int write_legacy_binding(uint32_t binding_idx) {
+    const struct zmk_behavior_binding *binding =
+        zmk_keymap_get_layer_binding_at_idx(0, binding_idx);
+    if (!binding) {
+        return -EINVAL;
+    }
+
+    struct {
+        zmk_behavior_local_id_t behavior_local_id;
+        uint32_t param1;
+        uint32_t param2;
+    } __packed binding_setting = {
+        .behavior_local_id = zmk_behavior_get_local_id(binding->behavior_dev),
+        .param1 = binding->param1,
+        .param2 = binding->param2,
+    };
+
+    char setting_name[20];
+    sprintf(setting_name, "keymap/l/0/%u", binding_idx);
+
+    return settings_save_one(setting_name, &binding_setting, sizeof(binding_setting));
+}
+
+static int discard_changes(void) {
+    uint32_t start = k_cycle_get_32();
+    int ret = zmk_keymap_discard_changes();
+
+    LOG_DBG("Loaded keymap settings in %u us", k_cyc_to_us_floor32(k_cycle_get_32() - start));
+
+    return ret;
+}
+
+static int on_keymap_settings_binding_pressed(struct zmk_behavior_binding *binding,
+                                              struct zmk_behavior_binding_event event) {
+    int ret;
+
+    switch (binding->param1) {
+    case KEYMAP_SETTINGS_SAVE:
+        ret = zmk_keymap_save_changes();
+        break;
+    case KEYMAP_SETTINGS_DISCARD:
+        ret = discard_changes();
+        break;
+    case KEYMAP_SETTINGS_WRITE_LEGACY:
+        ret = write_legacy_binding(binding->param2);
+        break;
+    default:
+        return -ENOTSUP;
+    }
+
+    if (ret < 0) {
+        LOG_ERR("Keymap settings command %d failed (err: %d)", binding->param1, ret);
+        return ret;
+    }
+
+    LOG_DBG("Keymap settings command %d done", binding->param1);
+
+    return 0;
+}
+
+static int on_keymap_settings_binding_released(struct zmk_behavior_binding *binding,
+                                               struct zmk_behavior_binding_event event) {
+    return 0;
+}
+
+static const struct behavior_driver_api behavior_keymap_settings_driver_api = {
+    .binding_pressed = on_keymap_settings_binding_pressed,
+    .binding_released = on_keymap_settings_binding_released};
+
+BEHAVIOR_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+                        &behavior_keymap_settings_driver_api);
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE) &&
+       // DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_behavior_latency_stats
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <drivers/behavior.h>
+#include <zephyr/logging/log.h>
+
+#include <zmk/behavior.h>
+#include <zmk/latency.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING) && DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
+
+// Logs how many traced key events reached each stage, and whether every stage was reached no
+// earlier than the one before it. Times depend on the build, so they aren't logged.
+static void log_stage_stats(void) {
+    struct zmk_latency_stats prev = {0};
+    bool in_order = true;
+
+    for (enum zmk_latency_stage stage = 0; stage < ZMK_LATENCY_STAGE_COUNT; stage++) {
+        struct zmk_latency_stats stats;
+        int ret = zmk_latency_get_stats(stage, &stats);
+
+        if (ret < 0) {
+            LOG_DBG("%s: no traces", zmk_latency_stage_name(stage));
+            continue;
+        }
+
+        LOG_DBG("%s: %u traces", zmk_latency_stage_name(stage), stats.count);
+
+        if (stats.min_us < prev.min_us || stats.max_us < prev.max_us) {
+            in_order = false;
+        }
+
+        prev = stats;
+    }
+
+    LOG_DBG("stages %s", in_order ? "in order" : "out of order");
+}
+
+static int on_latency_stats_binding_pressed(struct zmk_behavior_binding *binding,
+                                            struct zmk_behavior_binding_event event) {
+    log_stage_stats();
+    zmk_latency_reset();
+
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static int on_latency_stats_binding_released(struct zmk_behavior_binding *binding,
+                                             struct zmk_behavior_binding_event event) {
+    return ZMK_BEHAVIOR_OPAQUE;
+}
+
+static const struct behavior_driver_api behavior_latency_stats_driver_api = {
+    .binding_pressed = on_latency_stats_binding_pressed,
+    .binding_released = on_latency_stats_binding_released};
+
+BEHAVIOR_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT,
+                        &behavior_latency_stats_driver_api);
+
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING) && DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
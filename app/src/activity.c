@@ -22,6 +22,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zmk/activity.h>
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_GOVERNOR)
+#include <zmk/kscan_governor.h>
+#endif
+
 #if IS_ENABLED(CONFIG_USB_DEVICE_STACK)
 #include <zmk/usb.h>
 #endif
@@ -58,6 +62,11 @@ int set_state(enum zmk_activity_state state) {
         return 0;
 
     activity_state = state;
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_GOVERNOR)
+    zmk_kscan_governor_set_idle(state != ZMK_ACTIVITY_ACTIVE);
+#endif
+
     return raise_event();
 }
 
@@ -6,6 +6,7 @@
 
 #include <zephyr/device.h>
 #include <zephyr/init.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/crc.h>
 #include <zephyr/sys/util_macro.h>
 #include <string.h>
@@ -26,6 +27,10 @@
 #include <zmk/hid.h>
 #include <zmk/matrix.h>
 
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+#include <zmk/latency.h>
+#endif
+
 #include <zmk/events/position_state_changed.h>
 
 #include <zephyr/logging/log.h>
@@ -55,6 +60,14 @@ const struct device *z_impl_behavior_get_binding(const char *name) {
     return NULL;
 }
 
+const struct device *zmk_behavior_get_binding_device(const struct zmk_behavior_binding *binding) {
+    if (binding->device) {
+        return device_is_ready(binding->device) ? binding->device : NULL;
+    }
+
+    return zmk_behavior_get_binding(binding->behavior_dev);
+}
+
 static int invoke_locally(struct zmk_behavior_binding *binding,
                           struct zmk_behavior_binding_event event, bool pressed) {
     if (pressed) {
@@ -70,7 +83,11 @@ int zmk_behavior_invoke_binding(const struct zmk_behavior_binding *src_binding,
     // relative to absolute before being invoked
     struct zmk_behavior_binding binding = *src_binding;
 
-    const struct device *behavior = zmk_behavior_get_binding(binding.behavior_dev);
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    zmk_latency_trace_mark(ZMK_LATENCY_STAGE_BEHAVIOR_INVOKED);
+#endif
+
+    const struct device *behavior = zmk_behavior_get_binding_device(&binding);
 
     if (!behavior) {
         LOG_WRN("No behavior assigned to %d on layer %d", event.position, event.layer);
@@ -239,7 +256,7 @@ int zmk_behavior_check_params_match_metadata(const struct behavior_parameter_met
 
 int zmk_behavior_validate_binding(const struct zmk_behavior_binding *binding) {
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
-    const struct device *behavior = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *behavior = zmk_behavior_get_binding_device(binding);
 
     if (!behavior) {
         return -ENODEV;
@@ -267,7 +284,9 @@ zmk_behavior_local_id_t zmk_behavior_get_local_id(const char *name) {
     }
 
     STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
-        if (device_is_ready(item->device) && strcmp(item->device->name, name) == 0) {
+        // Bindings usually point at the device's own name, so try the cheap comparison first.
+        if (device_is_ready(item->device) &&
+            (item->device->name == name || strcmp(item->device->name, name) == 0)) {
             return item->local_id;
         }
     }
@@ -285,6 +304,34 @@ const char *zmk_behavior_find_behavior_name_from_local_id(zmk_behavior_local_id_
     return NULL;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
+uint32_t zmk_behavior_local_id_table_hash(void) {
+    uint32_t hash = 0;
+
+    STRUCT_SECTION_FOREACH(zmk_behavior_local_id_map, item) {
+        enum behavior_locality locality = BEHAVIOR_LOCALITY_CENTRAL;
+
+        // Behaviors which only run on the central are left out of peripheral builds.
+        if (!device_is_ready(item->device) ||
+            behavior_get_locality(item->device, &locality) < 0 ||
+            locality == BEHAVIOR_LOCALITY_CENTRAL) {
+            continue;
+        }
+
+        uint8_t id[2];
+        sys_put_le16(item->local_id, id);
+
+        // Summed so the order behaviors are linked in doesn't matter.
+        hash += crc32_ieee_update(crc32_ieee(id, sizeof(id)), item->device->name,
+                                  strlen(item->device->name));
+    }
+
+    return hash;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_ID_TYPE_CRC16)
 
 static int behavior_local_id_init(void) {
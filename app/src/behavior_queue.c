@@ -10,6 +10,11 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <drivers/behavior.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+#include <zmk/events/keycode_state_changed.h>
+#endif
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -18,7 +23,15 @@ struct q_item {
 #if IS_ENABLED(CONFIG_ZMK_SPLIT)
     uint8_t source;
 #endif
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    bool is_sequence;
+    union {
+        struct zmk_behavior_binding binding;
+        struct zmk_behavior_queue_sequence sequence;
+    };
+#else
     struct zmk_behavior_binding binding;
+#endif
     bool press : 1;
     uint32_t wait : 31;
 };
@@ -28,10 +41,123 @@ K_MSGQ_DEFINE(zmk_behavior_queue_msgq, sizeof(struct q_item), CONFIG_ZMK_BEHAVIO
 static void behavior_queue_process_next(struct k_work *work);
 static K_WORK_DELAYABLE_DEFINE(queue_work, behavior_queue_process_next);
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+// The sequence which is currently running, if any. It stays here rather than in the queue while
+// it waits between steps.
+static struct q_item running_sequence;
+static bool sequence_running;
+// Whether the key of the current tap step has been pressed but not released yet.
+static bool sequence_tap_pressed;
+
+/**
+ * Runs the next key step of the running sequence.
+ *
+ * @returns The time to wait before the following step, or -1 if the sequence has finished.
+ */
+static int32_t sequence_step(void) {
+    struct zmk_behavior_queue_sequence *seq = &running_sequence.sequence;
+
+    for (; seq->count > 0; seq->start++, seq->count--) {
+        const struct zmk_behavior_queue_step *step = &seq->steps[seq->start];
+        bool pressed;
+        uint32_t wait;
+
+        switch (step->type) {
+        case ZMK_BEHAVIOR_QUEUE_STEP_MODE_TAP:
+            seq->mode = ZMK_BEHAVIOR_QUEUE_KEY_TAP;
+            continue;
+        case ZMK_BEHAVIOR_QUEUE_STEP_MODE_PRESS:
+            seq->mode = ZMK_BEHAVIOR_QUEUE_KEY_PRESS;
+            continue;
+        case ZMK_BEHAVIOR_QUEUE_STEP_MODE_RELEASE:
+            seq->mode = ZMK_BEHAVIOR_QUEUE_KEY_RELEASE;
+            continue;
+        case ZMK_BEHAVIOR_QUEUE_STEP_TAP_TIME:
+            seq->tap_ms = step->param;
+            continue;
+        case ZMK_BEHAVIOR_QUEUE_STEP_WAIT_TIME:
+            seq->wait_ms = step->param;
+            continue;
+        case ZMK_BEHAVIOR_QUEUE_STEP_KEY:
+            break;
+        default:
+            LOG_ERR("Unsupported step type %d in behavior queue sequence", step->type);
+            continue;
+        }
+
+        switch (seq->mode) {
+        case ZMK_BEHAVIOR_QUEUE_KEY_TAP:
+            pressed = !sequence_tap_pressed;
+            wait = pressed ? seq->tap_ms : seq->wait_ms;
+            sequence_tap_pressed = pressed;
+            break;
+        case ZMK_BEHAVIOR_QUEUE_KEY_PRESS:
+            pressed = true;
+            wait = seq->wait_ms;
+            break;
+        default:
+            pressed = false;
+            wait = seq->wait_ms;
+            break;
+        }
+
+        LOG_DBG("Invoking %s: 0x%02x 0x%02x", seq->bindings[seq->start].behavior_dev,
+                step->param, 0);
+
+        raise_zmk_keycode_state_changed_from_encoded(step->param, pressed, k_uptime_get());
+
+        // A tapped key stays on the same step until it has been released.
+        if (!sequence_tap_pressed) {
+            seq->start++;
+            seq->count--;
+        }
+
+        return wait;
+    }
+
+    return -1;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
 static void behavior_queue_process_next(struct k_work *work) {
     struct q_item item = {.wait = 0};
 
-    while (k_msgq_get(&zmk_behavior_queue_msgq, &item, K_NO_WAIT) == 0) {
+    while (true) {
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+        if (sequence_running) {
+            int32_t wait = sequence_step();
+            if (wait < 0) {
+                sequence_running = false;
+                continue;
+            }
+
+            LOG_DBG("Processing next queued behavior in %dms", wait);
+
+            if (wait > 0) {
+                k_work_schedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &queue_work,
+                                          K_MSEC(wait));
+                break;
+            }
+
+            continue;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+        if (k_msgq_get(&zmk_behavior_queue_msgq, &item, K_NO_WAIT) < 0) {
+            break;
+        }
+
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+        if (item.is_sequence) {
+            running_sequence = item;
+            sequence_running = true;
+            sequence_tap_pressed = false;
+            continue;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
         LOG_DBG("Invoking %s: 0x%02x 0x%02x", item.binding.behavior_dev, item.binding.param1,
                 item.binding.param2);
 
@@ -51,12 +177,26 @@ static void behavior_queue_process_next(struct k_work *work) {
         LOG_DBG("Processing next queued behavior in %dms", item.wait);
 
         if (item.wait > 0) {
-            k_work_schedule(&queue_work, K_MSEC(item.wait));
+            k_work_schedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &queue_work,
+                                      K_MSEC(item.wait));
             break;
         }
     }
 }
 
+static int behavior_queue_put(const struct q_item *item) {
+    const int ret = k_msgq_put(&zmk_behavior_queue_msgq, item, K_NO_WAIT);
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (!k_work_delayable_is_pending(&queue_work)) {
+        behavior_queue_process_next(&queue_work.work);
+    }
+
+    return 0;
+}
+
 int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
                            const struct zmk_behavior_binding binding, bool press, uint32_t wait) {
     struct q_item item = {
@@ -69,14 +209,23 @@ int zmk_behavior_queue_add(const struct zmk_behavior_binding_event *event,
 #endif
     };
 
-    const int ret = k_msgq_put(&zmk_behavior_queue_msgq, &item, K_NO_WAIT);
-    if (ret < 0) {
-        return ret;
-    }
+    return behavior_queue_put(&item);
+}
 
-    if (!k_work_delayable_is_pending(&queue_work)) {
-        behavior_queue_process_next(&queue_work.work);
-    }
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
 
-    return 0;
+int zmk_behavior_queue_add_sequence(const struct zmk_behavior_binding_event *event,
+                                    const struct zmk_behavior_queue_sequence *sequence) {
+    struct q_item item = {
+        .is_sequence = true,
+        .sequence = *sequence,
+        .position = event->position,
+#if IS_ENABLED(CONFIG_ZMK_SPLIT)
+        .source = event->source,
+#endif
+    };
+
+    return behavior_queue_put(&item);
 }
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
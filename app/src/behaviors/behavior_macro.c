@@ -34,6 +34,13 @@ struct behavior_macro_trigger_state {
 struct behavior_macro_state {
     struct behavior_macro_trigger_state release_state;
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    // Whether the bindings run on press/release only press and release keys, so they can be run
+    // from the step table instead of queueing each binding.
+    bool press_is_key_sequence;
+    bool release_is_key_sequence;
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
 #if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
     struct behavior_parameter_metadata_set set;
 #endif // IS_ENABLED(CONFIG_ZMK_BEHAVIOR_METADATA)
@@ -45,6 +52,10 @@ struct behavior_macro_config {
     uint32_t default_wait_ms;
     uint32_t default_tap_ms;
     uint32_t count;
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    // The bindings, classified at build time.
+    const struct zmk_behavior_queue_step *steps;
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
     struct zmk_behavior_binding bindings[];
 };
 
@@ -111,6 +122,21 @@ static bool handle_control_binding(struct behavior_macro_trigger_state *state,
     return true;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+static bool is_key_sequence(const struct zmk_behavior_queue_step *steps, uint16_t start,
+                            uint16_t count) {
+    for (int i = start; i < start + count; i++) {
+        if (steps[i].type == ZMK_BEHAVIOR_QUEUE_STEP_OTHER) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
 static int behavior_macro_init(const struct device *dev) {
     const struct behavior_macro_config *cfg = dev->config;
     struct behavior_macro_state *state = dev->data;
@@ -135,6 +161,14 @@ static int behavior_macro_init(const struct device *dev) {
         }
     }
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    state->press_is_key_sequence = is_key_sequence(cfg->steps, 0, state->press_bindings_count);
+    state->release_is_key_sequence = is_key_sequence(cfg->steps, state->release_state.start_index,
+                                                     state->release_state.count);
+    LOG_DBG("Key sequence on press: %d, on release: %d", state->press_is_key_sequence,
+            state->release_is_key_sequence);
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
     return 0;
 };
 
@@ -160,6 +194,40 @@ static void replace_params(struct behavior_macro_trigger_state *state,
     state->param2_source = PARAM_SOURCE_BINDING;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+static int queue_key_sequence(struct zmk_behavior_binding_event *event,
+                              const struct behavior_macro_config *cfg,
+                              const struct behavior_macro_trigger_state *state) {
+    enum zmk_behavior_queue_key_mode mode;
+
+    switch (state->mode) {
+    case MACRO_MODE_PRESS:
+        mode = ZMK_BEHAVIOR_QUEUE_KEY_PRESS;
+        break;
+    case MACRO_MODE_RELEASE:
+        mode = ZMK_BEHAVIOR_QUEUE_KEY_RELEASE;
+        break;
+    default:
+        mode = ZMK_BEHAVIOR_QUEUE_KEY_TAP;
+        break;
+    }
+
+    struct zmk_behavior_queue_sequence sequence = {
+        .steps = cfg->steps,
+        .bindings = cfg->bindings,
+        .start = state->start_index,
+        .count = state->count,
+        .mode = mode,
+        .tap_ms = state->tap_ms,
+        .wait_ms = state->wait_ms,
+    };
+
+    return zmk_behavior_queue_add_sequence(event, &sequence);
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
 static void queue_macro(struct zmk_behavior_binding_event *event,
                         const struct zmk_behavior_binding bindings[],
                         struct behavior_macro_trigger_state state,
@@ -191,7 +259,7 @@ static void queue_macro(struct zmk_behavior_binding_event *event,
 
 static int on_macro_binding_pressed(struct zmk_behavior_binding *binding,
                                     struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_macro_config *cfg = dev->config;
     struct behavior_macro_state *state = dev->data;
     struct behavior_macro_trigger_state trigger_state = {.mode = MACRO_MODE_TAP,
@@ -200,6 +268,13 @@ static int on_macro_binding_pressed(struct zmk_behavior_binding *binding,
                                                          .start_index = 0,
                                                          .count = state->press_bindings_count};
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    if (state->press_is_key_sequence) {
+        queue_key_sequence(&event, cfg, &trigger_state);
+        return ZMK_BEHAVIOR_OPAQUE;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
     queue_macro(&event, cfg->bindings, trigger_state, binding);
 
     return ZMK_BEHAVIOR_OPAQUE;
@@ -207,10 +282,17 @@ static int on_macro_binding_pressed(struct zmk_behavior_binding *binding,
 
 static int on_macro_binding_released(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
-    const struct device *dev = zmk_behavior_get_binding(binding->behavior_dev);
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
     const struct behavior_macro_config *cfg = dev->config;
     struct behavior_macro_state *state = dev->data;
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+    if (state->release_is_key_sequence) {
+        queue_key_sequence(&event, cfg, &state->release_state);
+        return ZMK_BEHAVIOR_OPAQUE;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
     queue_macro(&event, cfg->bindings, state->release_state, binding);
 
     return ZMK_BEHAVIOR_OPAQUE;
@@ -315,12 +397,49 @@ static const struct behavior_driver_api behavior_macro_driver_api = {
 #define TRANSFORMED_BEHAVIORS(n)                                                                   \
     {LISTIFY(DT_PROP_LEN(n, bindings), ZMK_KEYMAP_EXTRACT_BINDING, (, ), n)},
 
+#if IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
+#define MACRO_STEP_TYPE_IF(node, compat, type)                                                     \
+    DT_NODE_HAS_COMPAT(node, compat) ? ZMK_BEHAVIOR_QUEUE_STEP_##type:
+
+// Control bindings are recognized at build time, so running a key sequence needs no name lookups.
+#define MACRO_STEP_TYPE(node)                                                                      \
+    (MACRO_STEP_TYPE_IF(node, zmk_behavior_key_press, KEY)                                         \
+     MACRO_STEP_TYPE_IF(node, zmk_macro_control_mode_tap, MODE_TAP)                                \
+     MACRO_STEP_TYPE_IF(node, zmk_macro_control_mode_press, MODE_PRESS)                            \
+     MACRO_STEP_TYPE_IF(node, zmk_macro_control_mode_release, MODE_RELEASE)                        \
+     MACRO_STEP_TYPE_IF(node, zmk_macro_control_tap_time, TAP_TIME)                                \
+     MACRO_STEP_TYPE_IF(node, zmk_macro_control_wait_time, WAIT_TIME)                              \
+     ZMK_BEHAVIOR_QUEUE_STEP_OTHER)
+
+#define MACRO_STEP(idx, n)                                                                         \
+    {                                                                                              \
+        .type = MACRO_STEP_TYPE(DT_PHANDLE_BY_IDX(n, bindings, idx)),                              \
+        .param = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(n, bindings, idx, param1), (0),                \
+                             (DT_PHA_BY_IDX(n, bindings, idx, param1))),                           \
+    }
+
+#define MACRO_STEPS_DEFINE(inst)                                                                   \
+    static const struct zmk_behavior_queue_step behavior_macro_steps_##inst[] = {                  \
+        LISTIFY(DT_PROP_LEN(inst, bindings), MACRO_STEP, (, ), inst)};
+
+#define MACRO_STEPS_REF(inst) .steps = behavior_macro_steps_##inst,
+
+#else
+
+#define MACRO_STEPS_DEFINE(inst)
+#define MACRO_STEPS_REF(inst)
+
+#endif // IS_ENABLED(CONFIG_ZMK_MACRO_KEY_SEQUENCES)
+
 #define MACRO_INST(inst)                                                                           \
+    MACRO_STEPS_DEFINE(inst)                                                                       \
     static struct behavior_macro_state behavior_macro_state_##inst = {};                           \
     static struct behavior_macro_config behavior_macro_config_##inst = {                           \
         .default_wait_ms = DT_PROP_OR(inst, wait_ms, CONFIG_ZMK_MACRO_DEFAULT_WAIT_MS),            \
         .default_tap_ms = DT_PROP_OR(inst, tap_ms, CONFIG_ZMK_MACRO_DEFAULT_TAP_MS),               \
         .count = DT_PROP_LEN(inst, bindings),                                                      \
+        MACRO_STEPS_REF(inst)                                                                      \
         .bindings = TRANSFORMED_BEHAVIORS(inst)};                                                  \
     BEHAVIOR_DT_DEFINE(inst, behavior_macro_init, NULL, &behavior_macro_state_##inst,              \
                        &behavior_macro_config_##inst, POST_KERNEL,                                 \
@@ -45,14 +45,14 @@ struct behavior_mo_config {
 static int mo_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                      struct zmk_behavior_binding_event event) {
     LOG_DBG("position %d layer %d", event.position, binding->param1);
-    const struct behavior_mo_config *cfg = zmk_behavior_get_binding(binding->behavior_dev)->config;
+    const struct behavior_mo_config *cfg = zmk_behavior_get_binding_device(binding)->config;
     return zmk_keymap_layer_activate(binding->param1, cfg->locking);
 }
 
 static int mo_keymap_binding_released(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
     LOG_DBG("position %d layer %d", event.position, binding->param1);
-    const struct behavior_mo_config *cfg = zmk_behavior_get_binding(binding->behavior_dev)->config;
+    const struct behavior_mo_config *cfg = zmk_behavior_get_binding_device(binding)->config;
     return zmk_keymap_layer_deactivate(binding->param1, cfg->locking);
 }
 
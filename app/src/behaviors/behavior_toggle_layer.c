@@ -32,7 +32,7 @@ static int tog_keymap_binding_pressed(struct zmk_behavior_binding *binding,
                                       struct zmk_behavior_binding_event event) {
     LOG_DBG("position %d layer %d", event.position, binding->param1);
 
-    const struct behavior_tog_config *cfg = zmk_behavior_get_binding(binding->behavior_dev)->config;
+    const struct behavior_tog_config *cfg = zmk_behavior_get_binding_device(binding)->config;
     switch (cfg->toggle_mode) {
     case ON:
         return zmk_keymap_layer_activate(binding->param1, cfg->locking);
@@ -21,6 +21,7 @@
 #include <zmk/hid.h>
 #include <zmk/matrix.h>
 #include <zmk/keymap.h>
+#include <zmk/timer_wheel.h>
 #include <zmk/virtual_key_position.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
@@ -104,24 +105,17 @@ static const struct combo_cfg combos[] = {
 
 #define COMBO_CHILDREN_COUNT (0 DT_INST_FOREACH_CHILD(0, COMBO_ONE))
 
-// We need at least 4 bytes to avoid alignment issues
-#define BYTES_FOR_COMBOS_MASK DIV_ROUND_UP(COMBO_CHILDREN_COUNT, 32)
-
 uint8_t pressed_keys_count = 0;
 // set of keys pressed
 struct zmk_position_state_changed_event pressed_keys[MAX_COMBO_KEYS] = {};
-// the set of candidate combos based on the currently pressed_keys
-uint32_t candidates[BYTES_FOR_COMBOS_MASK];
 // the last candidate that was completely pressed
 int16_t fully_pressed_combo = INT16_MAX;
-// a lookup dict that maps a key position to all combos on that position
-uint32_t combo_lookup[ZMK_KEYMAP_LEN][BYTES_FOR_COMBOS_MASK] = {};
 // combos that have been activated and still have (some) keys pressed
 // this array is always contiguous from 0.
 struct active_combo active_combos[CONFIG_ZMK_COMBO_MAX_PRESSED_COMBOS] = {};
 uint8_t active_combo_count = 0;
 
-struct k_work_delayable timeout_task;
+struct zmk_timer timeout_task;
 int64_t timeout_task_timeout_at;
 
 // this keeps track of the last non-combo, non-mod key tap
@@ -129,24 +123,24 @@ int64_t last_tapped_timestamp = INT32_MIN;
 // this keeps track of the last time a combo was pressed
 int64_t last_combo_timestamp = INT32_MIN;
 
+#if IS_ENABLED(CONFIG_ZMK_COMBO_MATCHER_STATS)
+
+static uint32_t candidate_checks;
+
+#define COUNT_CANDIDATE_CHECK() candidate_checks++
+
+#else
+
+#define COUNT_CANDIDATE_CHECK()
+
+#endif // IS_ENABLED(CONFIG_ZMK_COMBO_MATCHER_STATS)
+
 static void store_last_tapped(int64_t timestamp) {
     if (timestamp > last_combo_timestamp) {
         last_tapped_timestamp = timestamp;
     }
 }
 
-// Store the combo key pointer in the combos array, one pointer for each key position
-// The combos are sorted shortest-first, then by virtual-key-position.
-static int initialize_combo(size_t index) {
-    const struct combo_cfg *new_combo = &combos[index];
-
-    for (size_t kp = 0; kp < new_combo->key_position_len; kp++) {
-        sys_bitfield_set_bit((mem_addr_t)&combo_lookup[new_combo->key_positions[kp]], index);
-    }
-
-    return 0;
-}
-
 static bool combo_active_on_layer(const struct combo_cfg *combo, uint8_t layer) {
     if (!combo->layer_mask) {
         return true;
@@ -159,11 +153,184 @@ static bool is_quick_tap(const struct combo_cfg *combo, int64_t timestamp) {
     return (last_tapped_timestamp + combo->require_prior_idle_ms) > timestamp;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_COMBO_MATCHER_SPARSE)
+
+BUILD_ASSERT(COMBO_CHILDREN_COUNT < UINT16_MAX, "Too many combos");
+
+#define COMBO_KEY_POSITIONS_LEN(n) +DT_PROP_LEN(n, key_positions)
+
+#define COMBO_KEY_POSITIONS_TOTAL (0 DT_INST_FOREACH_CHILD(0, COMBO_KEY_POSITIONS_LEN))
+
+// The indexes of the combos using each key position, in ascending order. The combos using key
+// position `kp` are at `combo_lookup[combo_lookup_offsets[kp]]` up to, but not including,
+// `combo_lookup[combo_lookup_offsets[kp + 1]]`.
+static uint16_t combo_lookup_offsets[ZMK_KEYMAP_LEN + 1];
+static uint16_t combo_lookup[COMBO_KEY_POSITIONS_TOTAL];
+
+// The indexes of the combos still matching the pressed keys, in ascending order.
+static uint16_t candidates[COMBO_CHILDREN_COUNT];
+static uint16_t candidates_count;
+
+static bool combo_has_key_position(const struct combo_cfg *combo, int32_t position,
+                                   int16_t before) {
+    for (int i = 0; i < before; i++) {
+        if (combo->key_positions[i] == position) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void initialize_combos(void) {
+    // Count the combos on each key position, turn the counts into offsets, then fill in the
+    // combos, using the offsets as cursors.
+    for (size_t i = 0; i < ARRAY_SIZE(combos); i++) {
+        const struct combo_cfg *combo = &combos[i];
+
+        for (int kp = 0; kp < combo->key_position_len; kp++) {
+            int32_t position = combo->key_positions[kp];
+
+            if (position >= ZMK_KEYMAP_LEN) {
+                LOG_ERR("Combo %d uses key position %d, which is out of range", i, position);
+                continue;
+            }
+
+            if (!combo_has_key_position(combo, position, kp)) {
+                combo_lookup_offsets[position + 1]++;
+            }
+        }
+    }
+
+    for (int kp = 1; kp <= ZMK_KEYMAP_LEN; kp++) {
+        combo_lookup_offsets[kp] += combo_lookup_offsets[kp - 1];
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(combos); i++) {
+        const struct combo_cfg *combo = &combos[i];
+
+        for (int kp = 0; kp < combo->key_position_len; kp++) {
+            int32_t position = combo->key_positions[kp];
+
+            if (position < ZMK_KEYMAP_LEN && !combo_has_key_position(combo, position, kp)) {
+                combo_lookup[combo_lookup_offsets[position]++] = i;
+            }
+        }
+    }
+
+    // Each cursor has now advanced to the start of the next key position.
+    for (int kp = ZMK_KEYMAP_LEN; kp > 0; kp--) {
+        combo_lookup_offsets[kp] = combo_lookup_offsets[kp - 1];
+    }
+    combo_lookup_offsets[0] = 0;
+}
+
+static int setup_candidates_for_first_keypress(int32_t position, int64_t timestamp) {
+    candidates_count = 0;
+
+    if (position >= ZMK_KEYMAP_LEN) {
+        return 0;
+    }
+
+    uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
+
+    for (int i = combo_lookup_offsets[position]; i < combo_lookup_offsets[position + 1]; i++) {
+        const struct combo_cfg *combo = &combos[combo_lookup[i]];
+
+        COUNT_CANDIDATE_CHECK();
+        if (combo_active_on_layer(combo, highest_active_layer) &&
+            !is_quick_tap(combo, timestamp)) {
+            candidates[candidates_count++] = combo_lookup[i];
+        }
+    }
+
+    return candidates_count;
+}
+
+static int filter_candidates(int32_t position) {
+    int matches = 0;
+
+    for (int i = 0; i < candidates_count; i++) {
+        const struct combo_cfg *combo = &combos[candidates[i]];
+
+        COUNT_CANDIDATE_CHECK();
+        if (combo_has_key_position(combo, position, combo->key_position_len)) {
+            candidates[matches++] = candidates[i];
+        }
+    }
+
+    candidates_count = matches;
+
+    LOG_DBG("combo matches after filter %d", matches);
+    return matches;
+}
+
+static int64_t first_candidate_timeout() {
+    if (pressed_keys_count == 0) {
+        return LONG_MAX;
+    }
+
+    int64_t first_timeout = LONG_MAX;
+    for (int i = 0; i < candidates_count; i++) {
+        COUNT_CANDIDATE_CHECK();
+        first_timeout = MIN(first_timeout, combos[candidates[i]].timeout_ms);
+    }
+
+    return pressed_keys[0].data.timestamp + first_timeout;
+}
+
+static int filter_timed_out_candidates(int64_t timestamp) {
+    __ASSERT(pressed_keys_count > 0, "Searching for a candidate timeout with no keys pressed");
+
+    int remaining_candidates = 0;
+    for (int i = 0; i < candidates_count; i++) {
+        COUNT_CANDIDATE_CHECK();
+        if (pressed_keys[0].data.timestamp + combos[candidates[i]].timeout_ms > timestamp) {
+            candidates[remaining_candidates++] = candidates[i];
+        }
+    }
+
+    candidates_count = remaining_candidates;
+
+    LOG_DBG(
+        "after filtering out timed out combo candidates: remaining_candidates=%d timestamp=%lld",
+        remaining_candidates, timestamp);
+
+    return remaining_candidates;
+}
+
+static int first_candidate(void) { return candidates_count > 0 ? candidates[0] : -ENOENT; }
+
+static void clear_candidates(void) { candidates_count = 0; }
+
+#else
+
+// We need at least 4 bytes to avoid alignment issues
+#define BYTES_FOR_COMBOS_MASK DIV_ROUND_UP(COMBO_CHILDREN_COUNT, 32)
+
+// the set of candidate combos based on the currently pressed_keys
+uint32_t candidates[BYTES_FOR_COMBOS_MASK];
+// a lookup dict that maps a key position to all combos on that position
+uint32_t combo_lookup[ZMK_KEYMAP_LEN][BYTES_FOR_COMBOS_MASK] = {};
+
+// Store the combo key pointer in the combos array, one pointer for each key position
+// The combos are sorted shortest-first, then by virtual-key-position.
+static void initialize_combos(void) {
+    for (size_t index = 0; index < ARRAY_SIZE(combos); index++) {
+        const struct combo_cfg *new_combo = &combos[index];
+
+        for (size_t kp = 0; kp < new_combo->key_position_len; kp++) {
+            sys_bitfield_set_bit((mem_addr_t)&combo_lookup[new_combo->key_positions[kp]], index);
+        }
+    }
+}
+
 static int setup_candidates_for_first_keypress(int32_t position, int64_t timestamp) {
     int number_of_combo_candidates = 0;
     uint8_t highest_active_layer = zmk_keymap_highest_layer_active();
 
     for (size_t i = 0; i < ARRAY_SIZE(combos); i++) {
+        COUNT_CANDIDATE_CHECK();
         if (sys_bitfield_test_bit((mem_addr_t)&combo_lookup[position], i)) {
             const struct combo_cfg *combo = &combos[i];
             if (combo_active_on_layer(combo, highest_active_layer) &&
@@ -191,6 +358,7 @@ static inline uint8_t zero_one_or_more_bits(uint32_t field) {
 static int filter_candidates(int32_t position) {
     int matches = 0;
     for (int i = 0; i < BYTES_FOR_COMBOS_MASK; i++) {
+        COUNT_CANDIDATE_CHECK();
         candidates[i] &= combo_lookup[position][i];
         if (matches < 2) {
             matches += zero_one_or_more_bits(candidates[i]);
@@ -208,6 +376,7 @@ static int64_t first_candidate_timeout() {
 
     int64_t first_timeout = LONG_MAX;
     for (int i = 0; i < ARRAY_SIZE(combos); i++) {
+        COUNT_CANDIDATE_CHECK();
         if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
             first_timeout = MIN(first_timeout, combos[i].timeout_ms);
         }
@@ -216,22 +385,12 @@ static int64_t first_candidate_timeout() {
     return pressed_keys[0].data.timestamp + first_timeout;
 }
 
-static inline bool candidate_is_completely_pressed(const struct combo_cfg *candidate) {
-    // this code assumes set(pressed_keys) <= set(candidate->key_positions)
-    // this invariant is enforced by filter_candidates
-    // since events may have been reraised after clearing one or more slots at
-    // the start of pressed_keys (see: release_pressed_keys), we have to check
-    // that each key needed to trigger the combo was pressed, not just the last.
-    return candidate->key_position_len == pressed_keys_count;
-}
-
-static int cleanup();
-
 static int filter_timed_out_candidates(int64_t timestamp) {
     __ASSERT(pressed_keys_count > 0, "Searching for a candidate timeout with no keys pressed");
 
     int remaining_candidates = 0;
     for (int i = 0; i < ARRAY_SIZE(combos); i++) {
+        COUNT_CANDIDATE_CHECK();
         if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
 
             if (pressed_keys[0].data.timestamp + combos[i].timeout_ms > timestamp) {
@@ -249,6 +408,34 @@ static int filter_timed_out_candidates(int64_t timestamp) {
     return remaining_candidates;
 }
 
+static int first_candidate(void) {
+    for (int i = 0; i < ARRAY_SIZE(combos); i++) {
+        COUNT_CANDIDATE_CHECK();
+        if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
+            return i;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static void clear_candidates(void) {
+    memset(candidates, 0, BYTES_FOR_COMBOS_MASK * sizeof(uint32_t));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_COMBO_MATCHER_SPARSE)
+
+static inline bool candidate_is_completely_pressed(const struct combo_cfg *candidate) {
+    // this code assumes set(pressed_keys) <= set(candidate->key_positions)
+    // this invariant is enforced by filter_candidates
+    // since events may have been reraised after clearing one or more slots at
+    // the start of pressed_keys (see: release_pressed_keys), we have to check
+    // that each key needed to trigger the combo was pressed, not just the last.
+    return candidate->key_position_len == pressed_keys_count;
+}
+
+static int cleanup();
+
 static int capture_pressed_key(const struct zmk_position_state_changed *ev) {
     if (pressed_keys_count == MAX_COMBO_KEYS) {
         return ZMK_EV_EVENT_BUBBLE;
@@ -394,12 +581,17 @@ static bool release_combo_key(int32_t position, int64_t timestamp) {
 }
 
 static int cleanup() {
-    k_work_cancel_delayable(&timeout_task);
-    memset(candidates, 0, BYTES_FOR_COMBOS_MASK * sizeof(uint32_t));
+    zmk_timer_stop(&timeout_task);
+    clear_candidates();
     if (fully_pressed_combo != INT16_MAX) {
         activate_combo(fully_pressed_combo);
         fully_pressed_combo = INT16_MAX;
     }
+
+#if IS_ENABLED(CONFIG_ZMK_COMBO_MATCHER_STATS)
+    LOG_INF("combo: %u candidate checks so far", candidate_checks);
+#endif
+
     return release_pressed_keys();
 }
 
@@ -410,12 +602,11 @@ static void update_timeout_task() {
     }
     if (first_timeout == LLONG_MAX) {
         timeout_task_timeout_at = 0;
-        k_work_cancel_delayable(&timeout_task);
+        zmk_timer_stop(&timeout_task);
         return;
     }
-    if (k_work_schedule(&timeout_task, K_MSEC(first_timeout - k_uptime_get())) >= 0) {
-        timeout_task_timeout_at = first_timeout;
-    }
+    zmk_timer_start(&timeout_task, first_timeout);
+    timeout_task_timeout_at = first_timeout;
 }
 
 static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_changed *data) {
@@ -435,18 +626,18 @@ static int position_state_down(const zmk_event_t *ev, struct zmk_position_state_
     update_timeout_task();
 
     if (num_candidates) {
-        for (int i = 0; i < ARRAY_SIZE(combos); i++) {
-            if (sys_bitfield_test_bit((mem_addr_t)&candidates, i)) {
-                const struct combo_cfg *candidate_combo = &combos[i];
-                if (candidate_is_completely_pressed(candidate_combo)) {
-                    fully_pressed_combo = i;
-                    if (num_candidates == 1) {
-                        cleanup();
-                    }
+        // Candidates are sorted shortest first, so if any is completely pressed, the first one is.
+        int i = first_candidate();
+        if (i >= 0) {
+            const struct combo_cfg *candidate_combo = &combos[i];
+            if (candidate_is_completely_pressed(candidate_combo)) {
+                fully_pressed_combo = i;
+                if (num_candidates == 1) {
+                    cleanup();
                 }
-
-                return ret;
             }
+
+            return ret;
         }
     } else {
         cleanup();
@@ -472,11 +663,7 @@ static int position_state_up(const zmk_event_t *ev, struct zmk_position_state_ch
     return ZMK_EV_EVENT_BUBBLE;
 }
 
-static void combo_timeout_handler(struct k_work *item) {
-    if (timeout_task_timeout_at == 0 || k_uptime_get() < timeout_task_timeout_at) {
-        // timer was cancelled or rescheduled.
-        return;
-    }
+static void combo_timeout_handler(struct zmk_timer *timer) {
     if (filter_timed_out_candidates(timeout_task_timeout_at) == 0) {
         LOG_DBG("CLEANUP!");
         cleanup();
@@ -525,11 +712,9 @@ static int combo_init(void) {
         active_combos[i].combo_idx = UINT16_MAX;
     }
 
-    k_work_init_delayable(&timeout_task, combo_timeout_handler);
+    zmk_timer_init(&timeout_task, combo_timeout_handler);
     LOG_WRN("Have %d combos!", ARRAY_SIZE(combos));
-    for (int i = 0; i < ARRAY_SIZE(combos); i++) {
-        initialize_combo(i);
-    }
+    initialize_combos();
     return 0;
 }
 
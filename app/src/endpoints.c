@@ -5,9 +5,12 @@
  */
 
 #include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
 #include <zephyr/settings/settings.h>
 
 #include <stdio.h>
+#include <string.h>
 
 #include <zmk/ble.h>
 #include <zmk/endpoints.h>
@@ -20,6 +23,11 @@
 #include <zmk/events/ble_active_profile_changed.h>
 #include <zmk/events/usb_conn_state_changed.h>
 #include <zmk/events/endpoint_changed.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+#include <zmk/latency.h>
+#endif
 
 #include <zephyr/logging/log.h>
 
@@ -64,7 +72,9 @@ static struct k_work_delayable endpoints_save_work;
 
 static int endpoints_save_preferred(void) {
 #if IS_ENABLED(CONFIG_SETTINGS)
-    return k_work_reschedule(&endpoints_save_work, K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+    return k_work_reschedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(SETTINGS_SAVE)),
+                                       &endpoints_save_work,
+                                       K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
 #else
     return 0;
 #endif
@@ -173,14 +183,14 @@ struct zmk_endpoint_instance zmk_endpoint_get_selected(void) { return current_in
 
 bool zmk_endpoint_is_connected(void) { return current_instance.transport != ZMK_TRANSPORT_NONE; }
 
-static int send_keyboard_report(void) {
+static int send_keyboard_report(struct zmk_hid_keyboard_report_body *body) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_NONE:
         return 0;
 
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
-        int err = zmk_usb_hid_send_keyboard_report();
+        int err = zmk_usb_hid_send_keyboard_report_body(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER USB: %d", err);
         }
@@ -193,8 +203,7 @@ static int send_keyboard_report(void) {
 
     case ZMK_TRANSPORT_BLE: {
 #if IS_ENABLED(CONFIG_ZMK_BLE)
-        struct zmk_hid_keyboard_report *keyboard_report = zmk_hid_get_keyboard_report();
-        int err = zmk_hog_send_keyboard_report(&keyboard_report->body);
+        int err = zmk_hog_send_keyboard_report(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER HOG: %d", err);
         }
@@ -210,14 +219,14 @@ static int send_keyboard_report(void) {
     return -ENOTSUP;
 }
 
-static int send_consumer_report(void) {
+static int send_consumer_report(struct zmk_hid_consumer_report_body *body) {
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_NONE:
         return 0;
 
     case ZMK_TRANSPORT_USB: {
 #if IS_ENABLED(CONFIG_ZMK_USB)
-        int err = zmk_usb_hid_send_consumer_report();
+        int err = zmk_usb_hid_send_consumer_report_body(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER USB: %d", err);
         }
@@ -230,8 +239,7 @@ static int send_consumer_report(void) {
 
     case ZMK_TRANSPORT_BLE: {
 #if IS_ENABLED(CONFIG_ZMK_BLE)
-        struct zmk_hid_consumer_report *consumer_report = zmk_hid_get_consumer_report();
-        int err = zmk_hog_send_consumer_report(&consumer_report->body);
+        int err = zmk_hog_send_consumer_report(body);
         if (err) {
             LOG_ERR("FAILED TO SEND OVER HOG: %d", err);
         }
@@ -247,15 +255,219 @@ static int send_consumer_report(void) {
     return -ENOTSUP;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+
+enum report_type {
+    REPORT_TYPE_KEYBOARD,
+    REPORT_TYPE_CONSUMER,
+};
+
+struct queued_report {
+    struct zmk_endpoint_instance endpoint;
+    enum report_type type;
+    union {
+        struct zmk_hid_keyboard_report_body keyboard;
+        struct zmk_hid_consumer_report_body consumer;
+    };
+};
+
+/**
+ * The last report of each type which was queued for an endpoint, i.e. what the host will see once
+ * the queue is flushed. A report type is dirty if the current report differs from this.
+ */
+struct endpoint_report_state {
+    // Bit per report type. Cleared if we don't know what the host has.
+    uint8_t known;
+    struct zmk_hid_keyboard_report_body keyboard;
+    struct zmk_hid_consumer_report_body consumer;
+};
+
+static struct endpoint_report_state endpoint_report_states[ZMK_ENDPOINT_COUNT];
+
+K_MSGQ_DEFINE(endpoint_report_msgq, sizeof(struct queued_report),
+              CONFIG_ZMK_ENDPOINT_REPORT_QUEUE_SIZE, 4);
+
+// Serializes flushes so reports reach the transport in the order they were queued.
+static K_MUTEX_DEFINE(endpoint_report_flush_mutex);
+
+static atomic_t reports_sent;
+static atomic_t reports_coalesced;
+
+static void forget_reports(struct zmk_endpoint_instance endpoint, uint8_t types) {
+    endpoint_report_states[zmk_endpoint_instance_to_index(endpoint)].known &= ~types;
+}
+
+// True if the transport still has a report of this type which the host hasn't taken.
+static bool report_waiting(enum report_type type) {
+    switch (current_instance.transport) {
+    case ZMK_TRANSPORT_USB:
+#if IS_ENABLED(CONFIG_ZMK_USB)
+        return type == REPORT_TYPE_KEYBOARD ? zmk_usb_hid_keyboard_report_waiting()
+                                            : zmk_usb_hid_consumer_report_waiting();
+#else
+        return false;
+#endif /* IS_ENABLED(CONFIG_ZMK_USB) */
+
+    case ZMK_TRANSPORT_BLE:
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+        return type == REPORT_TYPE_KEYBOARD ? zmk_hog_keyboard_report_waiting()
+                                            : zmk_hog_consumer_report_waiting();
+#else
+        return false;
+#endif /* IS_ENABLED(CONFIG_ZMK_BLE) */
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Hands queued reports to the transport. Unless @p force is set, this stops at the first report
+ * whose type the transport still has waiting, so reports go out once per USB poll or BLE
+ * connection event. The transport calls zmk_endpoint_report_tx_ready() to resume.
+ */
+static void flush_reports(bool force) {
+    struct queued_report report;
+
+    k_mutex_lock(&endpoint_report_flush_mutex, K_FOREVER);
+
+    while (k_msgq_peek(&endpoint_report_msgq, &report) == 0) {
+        int err;
+
+        if (!zmk_endpoint_instance_eq(report.endpoint, current_instance)) {
+            LOG_DBG("Dropping report queued for a previous endpoint");
+            k_msgq_get(&endpoint_report_msgq, &report, K_NO_WAIT);
+            forget_reports(report.endpoint, BIT(report.type));
+            continue;
+        }
+
+        // Later reports wait too, so the host sees them in order.
+        if (!force && report_waiting(report.type)) {
+            break;
+        }
+
+        k_msgq_get(&endpoint_report_msgq, &report, K_NO_WAIT);
+
+        switch (report.type) {
+        case REPORT_TYPE_KEYBOARD:
+            err = send_keyboard_report(&report.keyboard);
+            break;
+
+        case REPORT_TYPE_CONSUMER:
+            err = send_consumer_report(&report.consumer);
+            break;
+
+        default:
+            err = -ENOTSUP;
+            break;
+        }
+
+        if (err < 0) {
+            // The host may not have what we think it has, so don't skip the next report.
+            forget_reports(report.endpoint, BIT(report.type));
+        } else {
+            atomic_inc(&reports_sent);
+        }
+    }
+
+    k_mutex_unlock(&endpoint_report_flush_mutex);
+}
+
+static void flush_reports_work_cb(struct k_work *work) { flush_reports(false); }
+
+static K_WORK_DEFINE(flush_reports_work, flush_reports_work_cb);
+
+void zmk_endpoint_report_tx_ready(void) {
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &flush_reports_work);
+}
+
+static int queue_report(enum report_type type, const void *body, size_t len) {
+    struct endpoint_report_state *state =
+        &endpoint_report_states[zmk_endpoint_instance_to_index(current_instance)];
+    struct queued_report report = {.endpoint = current_instance, .type = type};
+    void *last;
+
+    switch (type) {
+    case REPORT_TYPE_KEYBOARD:
+        last = &state->keyboard;
+        memcpy(&report.keyboard, body, len);
+        break;
+
+    case REPORT_TYPE_CONSUMER:
+        last = &state->consumer;
+        memcpy(&report.consumer, body, len);
+        break;
+
+    default:
+        return -ENOTSUP;
+    }
+
+    if ((state->known & BIT(type)) && memcmp(last, body, len) == 0) {
+        LOG_DBG("Report type %d is unchanged. Not sending it", type);
+        atomic_inc(&reports_coalesced);
+        return 0;
+    }
+
+    while (k_msgq_put(&endpoint_report_msgq, &report, K_NO_WAIT) < 0) {
+        // The host is falling behind. Let the transport's own queue merge what it can.
+        flush_reports(true);
+    }
+
+    memcpy(last, body, len);
+    state->known |= BIT(type);
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    zmk_latency_trace_mark(ZMK_LATENCY_STAGE_REPORT_SENT);
+#endif
+
+    // Everything raised while handling the current event is queued before this runs, so the
+    // whole batch is handed to the transport together. If the transport is still waiting for the
+    // host, the flush stops there and its tx-ready signal picks the rest up.
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &flush_reports_work);
+    return 0;
+}
+
+void zmk_endpoint_get_report_stats(struct zmk_endpoint_report_stats *stats) {
+    *stats = (struct zmk_endpoint_report_stats){
+        .sent = atomic_get(&reports_sent),
+        .coalesced = atomic_get(&reports_coalesced),
+    };
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+
 int zmk_endpoint_send_report(uint16_t usage_page) {
     LOG_DBG("usage page 0x%02X", usage_page);
+
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+    if (current_instance.transport == ZMK_TRANSPORT_NONE) {
+        return 0;
+    }
+
+    switch (usage_page) {
+    case HID_USAGE_KEY: {
+        struct zmk_hid_keyboard_report *report = zmk_hid_get_keyboard_report();
+        return queue_report(REPORT_TYPE_KEYBOARD, &report->body, sizeof(report->body));
+    }
+
+    case HID_USAGE_CONSUMER: {
+        struct zmk_hid_consumer_report *report = zmk_hid_get_consumer_report();
+        return queue_report(REPORT_TYPE_CONSUMER, &report->body, sizeof(report->body));
+    }
+    }
+#else
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    zmk_latency_trace_mark(ZMK_LATENCY_STAGE_REPORT_SENT);
+#endif
+
     switch (usage_page) {
     case HID_USAGE_KEY:
-        return send_keyboard_report();
+        return send_keyboard_report(&zmk_hid_get_keyboard_report()->body);
 
     case HID_USAGE_CONSUMER:
-        return send_consumer_report();
+        return send_consumer_report(&zmk_hid_get_consumer_report()->body);
     }
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
 
     LOG_ERR("Unsupported usage page %d", usage_page);
     return -ENOTSUP;
@@ -263,6 +475,11 @@ int zmk_endpoint_send_report(uint16_t usage_page) {
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
 int zmk_endpoint_send_mouse_report() {
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+    // Keep mouse reports in order with any keyboard reports, e.g. for shift+click.
+    flush_reports(true);
+#endif
+
     switch (current_instance.transport) {
     case ZMK_TRANSPORT_NONE:
         return 0;
@@ -298,6 +515,29 @@ int zmk_endpoint_send_mouse_report() {
     LOG_ERR("Unhandled endpoint transport %d", current_instance.transport);
     return -ENOTSUP;
 }
+
+bool zmk_endpoint_mouse_report_waiting(void) {
+    switch (current_instance.transport) {
+    case ZMK_TRANSPORT_NONE:
+        return false;
+
+    case ZMK_TRANSPORT_USB:
+#if IS_ENABLED(CONFIG_ZMK_USB)
+        return zmk_usb_hid_mouse_report_waiting();
+#else
+        return false;
+#endif /* IS_ENABLED(CONFIG_ZMK_USB) */
+
+    case ZMK_TRANSPORT_BLE:
+#if IS_ENABLED(CONFIG_ZMK_BLE)
+        return zmk_hog_mouse_report_waiting();
+#else
+        return false;
+#endif /* IS_ENABLED(CONFIG_ZMK_BLE) */
+    }
+
+    return false;
+}
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 #if IS_ENABLED(CONFIG_SETTINGS)
@@ -486,6 +726,14 @@ static void update_current_endpoint(void) {
         // Cancel all current keypresses so keys don't stay held on the old endpoint.
         zmk_endpoint_clear_reports();
 
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+        // Make sure the old endpoint gets the cleared reports before we switch away from it.
+        flush_reports(true);
+
+        // We don't know what the new endpoint's host last saw, e.g. if it reconnected.
+        forget_reports(new_instance, UINT8_MAX);
+#endif
+
         current_instance = new_instance;
 
         char endpoint_str[ZMK_ENDPOINT_STR_LEN];
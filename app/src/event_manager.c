@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <string.h>
+
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
@@ -14,17 +16,16 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 extern struct zmk_event_type *__event_type_start[];
 extern struct zmk_event_type *__event_type_end[];
 
-extern struct zmk_event_subscription __event_subscriptions_start[];
-extern struct zmk_event_subscription __event_subscriptions_end[];
+static inline uint8_t subscription_count(const struct zmk_event_type *type) {
+    return type->subscriptions_end - type->subscriptions_start;
+}
 
 int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     int ret = 0;
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
+    const struct zmk_event_subscription *subs = event->event->subscriptions_start;
+    uint8_t len = subscription_count(event->event);
     for (int i = start_index; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-        if (ev_sub->event_type != event->event) {
-            continue;
-        }
+        const struct zmk_event_subscription *ev_sub = subs + i;
         event->last_listener_index = i;
         ret = ev_sub->listener->callback(event);
         switch (ret) {
@@ -45,31 +46,41 @@ int zmk_event_manager_handle_from(zmk_event_t *event, uint8_t start_index) {
     return 0;
 }
 
-int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
+static int find_listener_index(const zmk_event_t *event, const struct zmk_listener *listener) {
+    const struct zmk_event_subscription *subs = event->event->subscriptions_start;
+    uint8_t len = subscription_count(event->event);
 
-int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
+    // Events re-raised by the listener that captured them still carry that listener's index.
+    if (event->last_listener_index < len && subs[event->last_listener_index].listener == listener) {
+        return event->last_listener_index;
+    }
 
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i + 1);
+    for (int i = 0; i < len; i++) {
+        if (subs[i].listener == listener) {
+            return i;
         }
     }
 
+    return -ENODEV;
+}
+
+int zmk_event_manager_raise(zmk_event_t *event) { return zmk_event_manager_handle_from(event, 0); }
+
+int zmk_event_manager_raise_after(zmk_event_t *event, const struct zmk_listener *listener) {
+    int idx = find_listener_index(event, listener);
+    if (idx >= 0) {
+        return zmk_event_manager_handle_from(event, idx + 1);
+    }
+
     LOG_WRN("Unable to find where to raise this after event");
 
     return -EINVAL;
 }
 
 int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *listener) {
-    uint8_t len = __event_subscriptions_end - __event_subscriptions_start;
-    for (int i = 0; i < len; i++) {
-        struct zmk_event_subscription *ev_sub = __event_subscriptions_start + i;
-
-        if (ev_sub->event_type == event->event && ev_sub->listener == listener) {
-            return zmk_event_manager_handle_from(event, i);
-        }
+    int idx = find_listener_index(event, listener);
+    if (idx >= 0) {
+        return zmk_event_manager_handle_from(event, idx);
     }
 
     LOG_WRN("Unable to find where to raise this event");
@@ -80,3 +91,56 @@ int zmk_event_manager_raise_at(zmk_event_t *event, const struct zmk_listener *li
 int zmk_event_manager_release(zmk_event_t *event) {
     return zmk_event_manager_handle_from(event, event->last_listener_index + 1);
 }
+
+static inline zmk_event_t *deferral_slot(const struct zmk_event_deferral *deferral,
+                                         uint16_t index) {
+    return (zmk_event_t *)(deferral->slots + (size_t)index * deferral->slot_size);
+}
+
+int zmk_event_deferral_defer(struct zmk_event_deferral *deferral, const zmk_event_t *event,
+                             size_t size, int32_t key) {
+    if (size > deferral->slot_size) {
+        return -EINVAL;
+    }
+
+    if (deferral->len >= deferral->capacity) {
+        LOG_WRN("Unable to hold %s event, too many events are held", event->event->name);
+        return -ENOMEM;
+    }
+
+    // While releasing, the slot written is never after the one being released, so it is either
+    // free or holds the event being released itself.
+    zmk_event_t *slot = deferral_slot(deferral, deferral->len++);
+    if (slot != event) {
+        memcpy(slot, event, size);
+    }
+
+    if (key >= 0 && key < deferral->key_count) {
+        deferral->key_counts[key]++;
+    } else if (key >= 0) {
+        LOG_WRN("Key %d is out of range for held events", key);
+    }
+
+    return 0;
+}
+
+bool zmk_event_deferral_has_key(const struct zmk_event_deferral *deferral, int32_t key) {
+    return key >= 0 && key < deferral->key_count && deferral->key_counts[key] > 0;
+}
+
+void zmk_event_deferral_release(struct zmk_event_deferral *deferral) {
+    uint16_t end = deferral->len;
+
+    // Events re-deferred while releasing are written from the start of the buffer. Each event
+    // released can be re-deferred at most once, so they never overtake the events still to be
+    // released, and no events need to be copied aside.
+    deferral->len = 0;
+    memset(deferral->key_counts, 0, deferral->key_count);
+
+    for (uint16_t i = 0; i < end; i++) {
+        zmk_event_t *event = deferral_slot(deferral, i);
+
+        LOG_DBG("Releasing held %s event", event->event->name);
+        zmk_event_manager_raise_at(event, deferral->listener);
+    }
+}
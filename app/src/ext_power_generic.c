@@ -15,6 +15,7 @@
 #include <zephyr/drivers/gpio.h>
 
 #include <drivers/ext_power.h>
+#include <zmk/workqueue.h>
 
 #if DT_HAS_COMPAT_STATUS_OKAY(DT_DRV_COMPAT)
 
@@ -49,7 +50,9 @@ static struct k_work_delayable ext_power_save_work;
 
 int ext_power_save_state(void) {
 #if IS_ENABLED(CONFIG_SETTINGS)
-    int ret = k_work_reschedule(&ext_power_save_work, K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+    int ret = k_work_reschedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(SETTINGS_SAVE)),
+                                          &ext_power_save_work,
+                                          K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
     return MIN(ret, 0);
 #else
     return 0;
@@ -134,7 +137,8 @@ static int ext_power_settings_commit() {
     if (!data->settings_init) {
 
         data->status = true;
-        k_work_schedule(&ext_power_save_work, K_NO_WAIT);
+        k_work_schedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(SETTINGS_SAVE)),
+                                  &ext_power_save_work, K_NO_WAIT);
 
         ext_power_enable(dev);
     }
@@ -249,6 +249,43 @@ static inline int check_keyboard_usage(zmk_key_t usage) {
 #error "A proper HID report type must be selected"
 #endif
 
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+
+static bool boot_report_add_key(zmk_hid_boot_report_t *boot, int *count, uint8_t key) {
+    if (*count == HID_BOOT_KEY_LEN) {
+        memset(boot->keys, HID_ERROR_ROLLOVER, HID_BOOT_KEY_LEN);
+        return false;
+    }
+
+    boot->keys[(*count)++] = key;
+    return true;
+}
+
+void zmk_hid_keyboard_body_to_boot_report(const struct zmk_hid_keyboard_report_body *body,
+                                          zmk_hid_boot_report_t *boot) {
+    int count = 0;
+
+    *boot = (zmk_hid_boot_report_t){.modifiers = body->modifiers};
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
+    for (int i = 0; i < sizeof(body->keys); i++) {
+        for (int j = 0; body->keys[i] && j < 8; j++) {
+            if ((body->keys[i] & BIT(j)) && !boot_report_add_key(boot, &count, i * 8 + j)) {
+                return;
+            }
+        }
+    }
+#else
+    for (int i = 0; i < CONFIG_ZMK_HID_KEYBOARD_REPORT_SIZE; i++) {
+        if (body->keys[i] && !boot_report_add_key(boot, &count, body->keys[i])) {
+            return;
+        }
+    }
+#endif
+}
+
+#endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
+
 #define TOGGLE_CONSUMER(match, val)                                                                \
     if (val > ZMK_HID_CONSUMER_MAX_USAGE) {                                                        \
         return -ENOTSUP;                                                                           \
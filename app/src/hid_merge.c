@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/hid_merge.h>
+
+bool zmk_hid_bits_revert(const uint8_t *base, const uint8_t *pending, const uint8_t *next,
+                         size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if ((base[i] ^ pending[i]) & (pending[i] ^ next[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline uint16_t get_usage(const uint8_t *usages, size_t i, size_t width) {
+    return width == 1 ? usages[i] : sys_get_le16(&usages[i]);
+}
+
+static bool has_usage(const uint8_t *usages, size_t len, size_t width, uint16_t usage) {
+    for (size_t i = 0; i < len; i += width) {
+        if (get_usage(usages, i, width) == usage) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool zmk_hid_usages_revert(const uint8_t *base, const uint8_t *pending, const uint8_t *next,
+                           size_t len, size_t width) {
+    const uint8_t *reports[] = {base, pending, next};
+
+    for (size_t r = 0; r < ARRAY_SIZE(reports); r++) {
+        for (size_t i = 0; i < len; i += width) {
+            uint16_t usage = get_usage(reports[r], i, width);
+            if (usage == 0) {
+                continue;
+            }
+
+            bool in_base = has_usage(base, len, width, usage);
+            bool in_pending = has_usage(pending, len, width, usage);
+            bool in_next = has_usage(next, len, width, usage);
+
+            if (in_base != in_pending && in_pending != in_next) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool zmk_hid_keyboard_body_reverts(const struct zmk_hid_keyboard_report_body *base,
+                                   const struct zmk_hid_keyboard_report_body *pending,
+                                   const struct zmk_hid_keyboard_report_body *next) {
+    if (zmk_hid_bits_revert(&base->modifiers, &pending->modifiers, &next->modifiers,
+                            sizeof(base->modifiers))) {
+        return true;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_HID_REPORT_TYPE_NKRO)
+    return zmk_hid_bits_revert(base->keys, pending->keys, next->keys, sizeof(base->keys));
+#else
+    return zmk_hid_usages_revert(base->keys, pending->keys, next->keys, sizeof(base->keys), 1);
+#endif
+}
+
+bool zmk_hid_consumer_body_reverts(const struct zmk_hid_consumer_report_body *base,
+                                   const struct zmk_hid_consumer_report_body *pending,
+                                   const struct zmk_hid_consumer_report_body *next) {
+    return zmk_hid_usages_revert((const uint8_t *)base->keys, (const uint8_t *)pending->keys,
+                                 (const uint8_t *)next->keys, sizeof(next->keys),
+                                 sizeof(next->keys[0]));
+}
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+
+static inline bool delta_fits(int16_t pending, int16_t next) {
+    int32_t sum = (int32_t)pending + next;
+    return sum >= INT16_MIN && sum <= INT16_MAX;
+}
+
+static inline int16_t add_delta(int16_t pending, int16_t next) {
+    return CLAMP((int32_t)pending + next, INT16_MIN, INT16_MAX);
+}
+
+bool zmk_hid_mouse_body_merge(const struct zmk_hid_mouse_report_body *base,
+                              struct zmk_hid_mouse_report_body *pending,
+                              const struct zmk_hid_mouse_report_body *next,
+                              enum zmk_hid_merge_mode mode) {
+    if (mode == ZMK_HID_MERGE_LOSSLESS &&
+        zmk_hid_bits_revert(&base->buttons, &pending->buttons, &next->buttons,
+                            sizeof(base->buttons))) {
+        return false;
+    }
+
+    if (mode != ZMK_HID_MERGE_FORCE &&
+        !(delta_fits(pending->d_x, next->d_x) && delta_fits(pending->d_y, next->d_y) &&
+          delta_fits(pending->d_scroll_y, next->d_scroll_y) &&
+          delta_fits(pending->d_scroll_x, next->d_scroll_x))) {
+        return false;
+    }
+
+    pending->buttons = next->buttons;
+    pending->d_x = add_delta(pending->d_x, next->d_x);
+    pending->d_y = add_delta(pending->d_y, next->d_y);
+    pending->d_scroll_y = add_delta(pending->d_scroll_y, next->d_scroll_y);
+    pending->d_scroll_x = add_delta(pending->d_scroll_x, next->d_scroll_x);
+    return true;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -6,6 +6,8 @@
 
 #include <zephyr/settings/settings.h>
 #include <zephyr/init.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/slist.h>
 
 #include <zephyr/logging/log.h>
 
@@ -15,12 +17,22 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zephyr/bluetooth/gatt.h>
 
 #include <zmk/ble.h>
+#include <zmk/endpoints.h>
 #include <zmk/endpoints_types.h>
 #include <zmk/hog.h>
 #include <zmk/hid.h>
+#include <zmk/hid_merge.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/ble_active_profile_changed.h>
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+#include <zmk/latency.h>
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+#include <zmk/pointing/report_accumulator.h>
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 #include <zmk/hid_indicators.h>
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
@@ -304,164 +316,371 @@ K_THREAD_STACK_DEFINE(hog_q_stack, CONFIG_ZMK_BLE_THREAD_STACK_SIZE);
 
 struct k_work_q hog_work_q;
 
-K_MSGQ_DEFINE(zmk_hog_keyboard_msgq, sizeof(struct zmk_hid_keyboard_report_body),
-              CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE, 4);
+// How long to wait before retrying a notification the stack had no buffer for, if there is no
+// other notification in flight whose completion would trigger the retry.
+#define HOG_TX_RETRY_MS 10
 
-void send_keyboard_report_callback(struct k_work *work) {
-    struct zmk_hid_keyboard_report_body report;
+enum hog_report_type {
+    HOG_REPORT_KEYBOARD,
+    HOG_REPORT_CONSUMER,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    HOG_REPORT_MOUSE,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    HOG_REPORT_TYPE_COUNT,
+};
 
-    while (k_msgq_get(&zmk_hog_keyboard_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
-        }
+union hog_report_body {
+    struct zmk_hid_keyboard_report_body keyboard;
+    struct zmk_hid_consumer_report_body consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report_body mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[5],
-            .data = &report,
-            .len = sizeof(report),
-        };
+struct hog_report {
+    sys_snode_t node;
+    enum hog_report_type type;
+    union hog_report_body body;
+};
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
+struct hog_report_type_info {
+    // Index of the report characteristic's value in hog_svc.
+    uint8_t attr_index;
+    uint16_t len;
+    uint8_t queue_size;
+};
+
+static const struct hog_report_type_info report_types[HOG_REPORT_TYPE_COUNT] = {
+    [HOG_REPORT_KEYBOARD] =
+        {
+            .attr_index = 5,
+            .len = sizeof(struct zmk_hid_keyboard_report_body),
+            .queue_size = CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE,
+        },
+    [HOG_REPORT_CONSUMER] =
+        {
+            .attr_index = 9,
+            .len = sizeof(struct zmk_hid_consumer_report_body),
+            .queue_size = CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE,
+        },
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    [HOG_REPORT_MOUSE] =
+        {
+            .attr_index = 13,
+            .len = sizeof(struct zmk_hid_mouse_report_body),
+            .queue_size = CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE,
+        },
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
 
-        bt_conn_unref(conn);
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+#define HOG_MOUSE_QUEUE_SIZE CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE
+#else
+#define HOG_MOUSE_QUEUE_SIZE 0
+#endif
+
+// Every queue can be full while the maximum number of reports are in flight.
+#define HOG_REPORT_POOL_SIZE                                                                       \
+    (CONFIG_ZMK_BLE_KEYBOARD_REPORT_QUEUE_SIZE + CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE +       \
+     HOG_MOUSE_QUEUE_SIZE + CONFIG_ZMK_BLE_HID_TX_MAX_IN_FLIGHT)
+
+K_MEM_SLAB_DEFINE_STATIC(hog_report_slab, sizeof(struct hog_report), HOG_REPORT_POOL_SIZE, 4);
+
+static struct k_spinlock hog_tx_lock;
+// Reports waiting to be notified, oldest first.
+static sys_slist_t hog_tx_pending = SYS_SLIST_STATIC_INIT(&hog_tx_pending);
+// The newest waiting report of each type, which is the only one new reports may be merged into.
+static struct hog_report *hog_tx_tails[HOG_REPORT_TYPE_COUNT];
+// The report the host will have seen just before each tail, to tell whether merging is lossless.
+static union hog_report_body hog_tx_bases[HOG_REPORT_TYPE_COUNT];
+// The newest report of each type, whether it has been notified yet or not.
+static union hog_report_body hog_tx_latest[HOG_REPORT_TYPE_COUNT];
+static uint8_t hog_tx_queued[HOG_REPORT_TYPE_COUNT];
+static struct zmk_hog_tx_stats hog_tx_stats;
+
+// Only accessed from hog_work_q, so it can be used without taking another reference per report.
+static struct bt_conn *active_conn;
+
+static void hog_tx_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(hog_tx_work, hog_tx_work_cb);
+
+static uint8_t hog_tx_queued_count(void) {
+    uint8_t count = 0;
+
+    for (int i = 0; i < HOG_REPORT_TYPE_COUNT; i++) {
+        count += hog_tx_queued[i];
     }
+
+    return count;
 }
 
-K_WORK_DEFINE(hog_keyboard_work, send_keyboard_report_callback);
+static void hog_tx_release(struct hog_report *report) {
+    k_mem_slab_free(&hog_report_slab, (void *)report);
+}
 
-int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_keyboard_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Keyboard message queue full, popping first message and queueing again");
-            struct zmk_hid_keyboard_report_body discarded_report;
-            k_msgq_get(&zmk_hog_keyboard_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_keyboard_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue keyboard report to send (%d)", err);
-            return err;
-        }
-    }
+static void hog_tx_notified(struct bt_conn *conn, void *user_data) {
+    struct hog_report *report = user_data;
 
-    k_work_submit_to_queue(&hog_work_q, &hog_keyboard_work);
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    if (report->type == HOG_REPORT_KEYBOARD) {
+        zmk_latency_report_delivered();
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
 
-    return 0;
-};
+    hog_tx_release(report);
 
-K_MSGQ_DEFINE(zmk_hog_consumer_msgq, sizeof(struct zmk_hid_consumer_report_body),
-              CONFIG_ZMK_BLE_CONSUMER_REPORT_QUEUE_SIZE, 4);
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+    hog_tx_stats.in_flight--;
+    hog_tx_stats.sent++;
+    k_spin_unlock(&hog_tx_lock, key);
 
-void send_consumer_report_callback(struct k_work *work) {
-    struct zmk_hid_consumer_report_body report;
+    k_work_reschedule_for_queue(&hog_work_q, &hog_tx_work, K_NO_WAIT);
+}
 
-    while (k_msgq_get(&zmk_hog_consumer_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
+static struct hog_report *hog_tx_pop(void) {
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+
+    struct hog_report *report = NULL;
+    if (hog_tx_stats.in_flight < CONFIG_ZMK_BLE_HID_TX_MAX_IN_FLIGHT) {
+        sys_snode_t *node = sys_slist_get(&hog_tx_pending);
+        if (node) {
+            report = CONTAINER_OF(node, struct hog_report, node);
+            if (hog_tx_tails[report->type] == report) {
+                hog_tx_tails[report->type] = NULL;
+            }
+            hog_tx_queued[report->type]--;
+            hog_tx_stats.in_flight++;
         }
+    }
 
-        struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[9],
-            .data = &report,
-            .len = sizeof(report),
-        };
+    k_spin_unlock(&hog_tx_lock, key);
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
-        if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
-        } else if (err) {
-            LOG_DBG("Error notifying %d", err);
-        }
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+    if (report && (report->type == HOG_REPORT_KEYBOARD || report->type == HOG_REPORT_CONSUMER)) {
+        zmk_endpoint_report_tx_ready();
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
 
-        bt_conn_unref(conn);
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+    if (report && report->type == HOG_REPORT_MOUSE) {
+        zmk_pointing_report_tx_ready();
     }
-};
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
 
-K_WORK_DEFINE(hog_consumer_work, send_consumer_report_callback);
+    return report;
+}
 
-int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_consumer_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_consumer_report_body discarded_report;
-            k_msgq_get(&zmk_hog_consumer_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_consumer_report(report);
-        }
-        default:
-            LOG_WRN("Failed to queue consumer report to send (%d)", err);
-            return err;
-        }
+// Puts back a report which hog_tx_pop() returned but which couldn't be sent yet.
+static void hog_tx_requeue(struct hog_report *report) {
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+
+    sys_slist_prepend(&hog_tx_pending, &report->node);
+    if (!hog_tx_tails[report->type]) {
+        hog_tx_tails[report->type] = report;
     }
+    hog_tx_queued[report->type]++;
+    hog_tx_stats.in_flight--;
 
-    k_work_submit_to_queue(&hog_work_q, &hog_consumer_work);
+    k_spin_unlock(&hog_tx_lock, key);
+}
 
-    return 0;
-};
+static void hog_tx_drop(struct hog_report *report) {
+    hog_tx_release(report);
 
-#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+    hog_tx_stats.in_flight--;
+    hog_tx_stats.dropped++;
+    k_spin_unlock(&hog_tx_lock, key);
+}
 
-K_MSGQ_DEFINE(zmk_hog_mouse_msgq, sizeof(struct zmk_hid_mouse_report_body),
-              CONFIG_ZMK_BLE_MOUSE_REPORT_QUEUE_SIZE, 4);
+static void hog_tx_work_cb(struct k_work *work) {
+    struct hog_report *report;
 
-void send_mouse_report_callback(struct k_work *work) {
-    struct zmk_hid_mouse_report_body report;
-    while (k_msgq_get(&zmk_hog_mouse_msgq, &report, K_NO_WAIT) == 0) {
-        struct bt_conn *conn = zmk_ble_active_profile_conn();
-        if (conn == NULL) {
-            return;
+    // Reports stay queued, where later ones can be merged into them, until the stack has finished
+    // with enough of the earlier notifications.
+    while ((report = hog_tx_pop()) != NULL) {
+        if (active_conn == NULL) {
+            hog_tx_drop(report);
+            continue;
         }
 
         struct bt_gatt_notify_params notify_params = {
-            .attr = &hog_svc.attrs[13],
-            .data = &report,
-            .len = sizeof(report),
+            .attr = &hog_svc.attrs[report_types[report->type].attr_index],
+            .data = &report->body,
+            .len = report_types[report->type].len,
+            .func = hog_tx_notified,
+            .user_data = report,
         };
 
-        int err = bt_gatt_notify_cb(conn, &notify_params);
+        int err = bt_gatt_notify_cb(active_conn, &notify_params);
+        if (err == -ENOMEM) {
+            hog_tx_requeue(report);
+            k_work_reschedule_for_queue(&hog_work_q, &hog_tx_work, K_MSEC(HOG_TX_RETRY_MS));
+            return;
+        }
+
         if (err == -EPERM) {
-            bt_conn_set_security(conn, BT_SECURITY_L2);
+            bt_conn_set_security(active_conn, BT_SECURITY_L2);
         } else if (err) {
             LOG_DBG("Error notifying %d", err);
         }
 
-        bt_conn_unref(conn);
+        if (err) {
+            hog_tx_drop(report);
+        }
     }
-};
+}
 
-K_WORK_DEFINE(hog_mouse_work, send_mouse_report_callback);
+static void hog_conn_update_cb(struct k_work *work) {
+    struct bt_conn *conn = zmk_ble_active_profile_conn();
 
-int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
-    int err = k_msgq_put(&zmk_hog_mouse_msgq, report, K_MSEC(100));
-    if (err) {
-        switch (err) {
-        case -EAGAIN: {
-            LOG_WRN("Consumer message queue full, popping first message and queueing again");
-            struct zmk_hid_mouse_report_body discarded_report;
-            k_msgq_get(&zmk_hog_mouse_msgq, &discarded_report, K_NO_WAIT);
-            return zmk_hog_send_mouse_report(report);
+    if (conn) {
+        struct bt_conn_info info;
+
+        // The stack can still find a connection which is being torn down.
+        if (bt_conn_get_info(conn, &info) < 0 || info.state != BT_CONN_STATE_CONNECTED) {
+            bt_conn_unref(conn);
+            conn = NULL;
+        }
+    }
+
+    if (active_conn) {
+        bt_conn_unref(active_conn);
+    }
+
+    active_conn = conn;
+
+    k_work_reschedule_for_queue(&hog_work_q, &hog_tx_work, K_NO_WAIT);
+}
+
+static K_WORK_DEFINE(hog_conn_update_work, hog_conn_update_cb);
+
+static bool hog_tx_merge(enum hog_report_type type, struct hog_report *pending,
+                         const union hog_report_body *next, enum zmk_hid_merge_mode mode) {
+    const union hog_report_body *base = &hog_tx_bases[type];
+    bool lossless = mode == ZMK_HID_MERGE_LOSSLESS;
+
+    switch (type) {
+    case HOG_REPORT_KEYBOARD:
+        if (lossless && zmk_hid_keyboard_body_reverts(&base->keyboard, &pending->body.keyboard,
+                                                      &next->keyboard)) {
+            return false;
         }
-        default:
-            LOG_WRN("Failed to queue mouse report to send (%d)", err);
-            return err;
+        break;
+    case HOG_REPORT_CONSUMER:
+        if (lossless && zmk_hid_consumer_body_reverts(&base->consumer, &pending->body.consumer,
+                                                      &next->consumer)) {
+            return false;
         }
+        break;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case HOG_REPORT_MOUSE:
+        return zmk_hid_mouse_body_merge(&base->mouse, &pending->body.mouse, &next->mouse, mode);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    default:
+        return false;
     }
 
-    k_work_submit_to_queue(&hog_work_q, &hog_mouse_work);
+    memcpy(&pending->body, next, report_types[type].len);
+    return true;
+}
+
+static int hog_tx_queue(enum hog_report_type type, const void *body) {
+    const struct hog_report_type_info *info = &report_types[type];
+    union hog_report_body next;
+    int ret = 0;
+
+    memcpy(&next, body, info->len);
+
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+
+    struct hog_report *tail = hog_tx_tails[type];
+    struct hog_report *report;
+
+    if (tail && hog_tx_merge(type, tail, &next, ZMK_HID_MERGE_LOSSLESS)) {
+        hog_tx_stats.merged++;
+        memcpy(&hog_tx_latest[type], &tail->body, info->len);
+    } else if (hog_tx_queued[type] < info->queue_size &&
+               k_mem_slab_alloc(&hog_report_slab, (void **)&report, K_NO_WAIT) == 0) {
+        report->type = type;
+        memcpy(&report->body, &next, info->len);
+        sys_slist_append(&hog_tx_pending, &report->node);
+
+        memcpy(&hog_tx_bases[type], &hog_tx_latest[type], info->len);
+        memcpy(&hog_tx_latest[type], &next, info->len);
+        hog_tx_tails[type] = report;
+        hog_tx_queued[type]++;
+    } else if (tail) {
+        // Rather than dropping the oldest report, fold this one into the newest. The host misses
+        // the change in between, but ends up with the right state.
+        hog_tx_merge(type, tail, &next, ZMK_HID_MERGE_FORCE);
+        memcpy(&hog_tx_latest[type], &tail->body, info->len);
+        hog_tx_stats.dropped++;
+    } else {
+        hog_tx_stats.dropped++;
+        ret = -ENOMEM;
+    }
+
+    hog_tx_stats.max_queued = MAX(hog_tx_stats.max_queued, hog_tx_queued_count());
+
+    k_spin_unlock(&hog_tx_lock, key);
+
+    if (ret < 0) {
+        LOG_WRN("Failed to queue HID report type %d to send (%d)", type, ret);
+        return ret;
+    }
+
+    k_work_reschedule_for_queue(&hog_work_q, &hog_tx_work, K_NO_WAIT);
 
     return 0;
-};
+}
+
+int zmk_hog_send_keyboard_report(struct zmk_hid_keyboard_report_body *report) {
+    return hog_tx_queue(HOG_REPORT_KEYBOARD, report);
+}
+
+int zmk_hog_send_consumer_report(struct zmk_hid_consumer_report_body *report) {
+    return hog_tx_queue(HOG_REPORT_CONSUMER, report);
+}
+
+static bool hog_tx_waiting(enum hog_report_type type) {
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+    bool waiting = hog_tx_queued[type] > 0;
+    k_spin_unlock(&hog_tx_lock, key);
+
+    return waiting;
+}
+
+bool zmk_hog_keyboard_report_waiting(void) { return hog_tx_waiting(HOG_REPORT_KEYBOARD); }
+
+bool zmk_hog_consumer_report_waiting(void) { return hog_tx_waiting(HOG_REPORT_CONSUMER); }
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+int zmk_hog_send_mouse_report(struct zmk_hid_mouse_report_body *report) {
+    return hog_tx_queue(HOG_REPORT_MOUSE, report);
+}
+
+bool zmk_hog_mouse_report_waiting(void) { return hog_tx_waiting(HOG_REPORT_MOUSE); }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
+void zmk_hog_get_tx_stats(struct zmk_hog_tx_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&hog_tx_lock);
+    *stats = hog_tx_stats;
+    stats->queued = hog_tx_queued_count();
+    k_spin_unlock(&hog_tx_lock, key);
+}
+
+static int hog_listener(const zmk_event_t *eh) {
+    // The active connection only changes when the active profile does, or when it connects or
+    // disconnects, all of which raise this event.
+    k_work_submit_to_queue(&hog_work_q, &hog_conn_update_work);
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(hog, hog_listener);
+ZMK_SUBSCRIPTION(hog, zmk_ble_active_profile_changed);
+
 static int zmk_hog_init(void) {
     static const struct k_work_queue_config queue_config = {.name = "HID Over GATT Send Work"};
     k_work_queue_start(&hog_work_q, hog_q_stack, K_THREAD_STACK_SIZEOF(hog_q_stack),
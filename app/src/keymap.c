@@ -7,6 +7,7 @@
 #include <drivers/behavior.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -17,6 +18,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/matrix.h>
 #include <zmk/sensors.h>
 #include <zmk/virtual_key_position.h>
+#include <zmk/varint.h>
 
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
@@ -35,9 +37,30 @@ static zmk_keymap_layer_id_t _zmk_keymap_layer_default = 0;
 
 #endif
 
+// Behaviors referenced by the keymap may not have a driver built in (e.g. `&bt` without BLE), so
+// their devices are referenced weakly. Those resolve to NULL and are looked up by name instead.
+#define KEYMAP_DECLARE_BEHAVIOR_DEVICE(node, prop, idx)                                            \
+    extern const struct device DEVICE_DT_NAME_GET(DT_PHANDLE_BY_IDX(node, prop, idx)) __weak;
+
+#define KEYMAP_DECLARE_LAYER_BEHAVIOR_DEVICES(node)                                                \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, bindings),                                                  \
+                (DT_FOREACH_PROP_ELEM(node, bindings, KEYMAP_DECLARE_BEHAVIOR_DEVICE)), ())
+
+ZMK_KEYMAP_LAYERS_FOREACH(KEYMAP_DECLARE_LAYER_BEHAVIOR_DEVICES)
+
+#define KEYMAP_EXTRACT_BINDING(idx, node)                                                          \
+    {                                                                                              \
+        .behavior_dev = DEVICE_DT_NAME(DT_PHANDLE_BY_IDX(node, bindings, idx)),                    \
+        .device = &DEVICE_DT_NAME_GET(DT_PHANDLE_BY_IDX(node, bindings, idx)),                     \
+        .param1 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(node, bindings, idx, param1), (0),            \
+                              (DT_PHA_BY_IDX(node, bindings, idx, param1))),                       \
+        .param2 = COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(node, bindings, idx, param2), (0),            \
+                              (DT_PHA_BY_IDX(node, bindings, idx, param2))),                       \
+    }
+
 #define TRANSFORMED_LAYER(node)                                                                    \
     {COND_CODE_1(DT_NODE_HAS_PROP(node, bindings),                                                 \
-                 (LISTIFY(DT_PROP_LEN(node, bindings), ZMK_KEYMAP_EXTRACT_BINDING, (, ), node)),   \
+                 (LISTIFY(DT_PROP_LEN(node, bindings), KEYMAP_EXTRACT_BINDING, (, ), node)),       \
                  ())}
 
 #if ZMK_KEYMAP_HAS_SENSORS
@@ -131,6 +154,48 @@ uint8_t map_layer_id_to_index(zmk_keymap_layer_id_t layer_id) {
 
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
+#define KEYMAP_TRANSPARENT_DEVICE(node) DEVICE_DT_GET(node),
+
+static const struct device *const transparent_behaviors[] = {
+    DT_FOREACH_STATUS_OKAY(zmk_behavior_transparent, KEYMAP_TRANSPARENT_DEVICE)};
+
+struct binding_cache_entry {
+    const struct zmk_behavior_binding *binding;
+    uint16_t generation;
+    uint8_t chain_idx;
+};
+
+// The active layers for `binding_cache_state`, from the highest layer index down to the default
+// layer. Each key position caches the first layer in this chain which has a non-transparent
+// binding, so resolving a key press is usually a single lookup.
+static zmk_keymap_layer_id_t binding_cache_chain[ZMK_KEYMAP_LAYERS_LEN];
+static uint8_t binding_cache_chain_len;
+static bool binding_cache_chain_valid;
+static zmk_keymap_layers_state_t binding_cache_state;
+
+static struct binding_cache_entry binding_cache[ZMK_KEYMAP_LEN];
+
+// Entries from any generation other than the current one are stale. Zero is never a current
+// generation, so the zero initialized entries start out stale.
+static uint16_t binding_cache_generation;
+
+static void invalidate_binding_cache(void) {
+    binding_cache_chain_valid = false;
+
+    if (++binding_cache_generation == 0) {
+        memset(binding_cache, 0, sizeof(binding_cache));
+        binding_cache_generation = 1;
+    }
+}
+
+#else
+
+static inline void invalidate_binding_cache(void) {}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
 static inline int set_layer_state(zmk_keymap_layer_id_t layer_id, bool state, bool locking) {
     int ret = 0;
     if (layer_id >= ZMK_KEYMAP_LAYERS_LEN) {
@@ -277,6 +342,12 @@ zmk_keymap_get_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint16_t bin
 
 static uint8_t zmk_keymap_layer_pending_changes[ZMK_KEYMAP_LAYERS_LEN][PENDING_ARRAY_SIZE];
 
+// Bindings which have per-key settings entries, saved by firmware from before layer entries.
+static uint8_t zmk_keymap_layer_legacy_bindings[ZMK_KEYMAP_LAYERS_LEN][PENDING_ARRAY_SIZE];
+
+// Layers whose bindings were loaded from a layer entry.
+static uint32_t packed_layers = 0;
+
 int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint16_t binding_idx,
                                         struct zmk_behavior_binding binding) {
     if (binding_idx >= ZMK_KEYMAP_LEN) {
@@ -304,6 +375,9 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint16_t
         return -EINVAL;
     }
 
+    // Resolve the device once here, rather than by name each time the binding is invoked.
+    binding.device = zmk_behavior_get_binding(binding.behavior_dev);
+
     if (memcmp(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding)) == 0) {
         LOG_DBG("Not setting, no change to layer %d at index %d (%d)", layer_id, binding_idx,
                 storage_binding_idx);
@@ -316,6 +390,7 @@ int zmk_keymap_set_layer_binding_at_idx(zmk_keymap_layer_id_t layer_id, uint16_t
 
     // TODO: Need a mutex to protect access to the keymap data?
     memcpy(&zmk_keymap[layer_id][storage_binding_idx], &binding, sizeof(binding));
+    invalidate_binding_cache();
 
     return 0;
 }
@@ -360,6 +435,8 @@ int zmk_keymap_move_layer(zmk_keymap_layer_index_t start_idx, zmk_keymap_layer_i
         keymap_layer_orders[dest_idx] = val;
     }
 
+    invalidate_binding_cache();
+
     return 0;
 }
 
@@ -378,6 +455,7 @@ int zmk_keymap_add_layer(void) {
         for (int candidate_id = 0; candidate_id < ZMK_KEYMAP_LAYERS_LEN; candidate_id++) {
             if (!(seen_layer_ids & BIT(candidate_id))) {
                 keymap_layer_orders[index] = candidate_id;
+                invalidate_binding_cache();
                 return index;
             }
         }
@@ -405,6 +483,8 @@ int zmk_keymap_remove_layer(zmk_keymap_layer_index_t index) {
 
     LOG_HEXDUMP_DBG(keymap_layer_orders, ZMK_KEYMAP_LAYERS_LEN, "Order");
 
+    invalidate_binding_cache();
+
     return 0;
 }
 
@@ -418,6 +498,8 @@ int zmk_keymap_restore_layer(zmk_keymap_layer_id_t id, zmk_keymap_layer_index_t
 
     keymap_layer_orders[at_index] = id;
 
+    invalidate_binding_cache();
+
     return 0;
 }
 
@@ -494,46 +576,271 @@ int zmk_keymap_check_unsaved_changes(void) {
 #define LAYER_ORDER_SETTINGS_KEY "keymap/layer_order"
 #define LAYER_NAME_SETTINGS_KEY "keymap/l_n/%d"
 #define LAYER_BINDING_SETTINGS_KEY "keymap/l/%d/%d"
+#define LAYER_BINDINGS_SETTINGS_KEY "keymap/lb/%d"
+
+// All of a layer's bindings are saved in one settings entry: a header, then one entry for each run
+// of identical bindings which differ from the stock keymap. Each entry is a varint for each of the
+// fields below.
+enum layer_bindings_entry_field {
+    // The number of bindings since the end of the previous run which match the stock keymap.
+    LAYER_BINDINGS_ENTRY_SKIP,
+    LAYER_BINDINGS_ENTRY_RUN_LEN,
+    LAYER_BINDINGS_ENTRY_LOCAL_ID,
+    LAYER_BINDINGS_ENTRY_PARAM1,
+    LAYER_BINDINGS_ENTRY_PARAM2,
+
+    LAYER_BINDINGS_ENTRY_FIELDS,
+};
 
-static int save_bindings(void) {
-    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
-        uint8_t *pending = zmk_keymap_layer_pending_changes[l];
+#define LAYER_BINDINGS_SETTING_VERSION 1
 
-        for (int kp = 0; kp < ZMK_KEYMAP_LEN; kp++) {
-            if (pending[kp / 8] & BIT(kp % 8)) {
+struct layer_bindings_setting_header {
+    uint8_t version;
+    uint8_t reserved;
+    // The keymap length of the firmware which saved the entry.
+    uint16_t keymap_len;
+    // CRC-32 of everything after the header.
+    uint32_t crc;
+} __packed;
 
-                const struct zmk_behavior_binding *binding = &zmk_keymap[l][kp];
-                LOG_DBG("Pending save for layer %d at key position %d: %s with %d, %d", l, kp,
-                        binding->behavior_dev, binding->param1, binding->param2);
-
-                struct zmk_behavior_binding_setting binding_setting = {
-                    .behavior_local_id = zmk_behavior_get_local_id(binding->behavior_dev),
-                    .param1 = binding->param1,
-                    .param2 = binding->param2,
-                };
-
-                // We can skip any trailing zero params, regardless of the behavior
-                // and if those params are meaningful.
-                size_t len = sizeof(binding_setting);
-                if (binding_setting.param2 == 0) {
-                    len -= 4;
-
-                    if (binding_setting.param1 == 0) {
-                        len -= 4;
-                    }
-                }
+static uint8_t layer_bindings_buf[sizeof(struct layer_bindings_setting_header) +
+                                  ZMK_KEYMAP_LEN * LAYER_BINDINGS_ENTRY_FIELDS *
+                                      ZMK_VARINT_MAX_LEN];
 
-                char setting_name[20];
-                sprintf(setting_name, LAYER_BINDING_SETTINGS_KEY, l, kp);
+static bool bindings_equal(const struct zmk_behavior_binding *a,
+                           const struct zmk_behavior_binding *b) {
+    if (a->param1 != b->param1 || a->param2 != b->param2) {
+        return false;
+    }
 
-                int ret = settings_save_one(setting_name, &binding_setting, len);
-                if (ret < 0) {
-                    LOG_ERR("Failed to save keymap binding at %d on layer %d (%d)", l, kp, ret);
-                    return ret;
-                }
+    if (!a->behavior_dev || !b->behavior_dev) {
+        return a->behavior_dev == b->behavior_dev;
+    }
+
+    return strcmp(a->behavior_dev, b->behavior_dev) == 0;
+}
+
+static bool any_bit_set(const uint8_t bits[PENDING_ARRAY_SIZE]) {
+    for (int i = 0; i < PENDING_ARRAY_SIZE; i++) {
+        if (bits[i]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns the encoded length, which is just the header if the layer matches the stock keymap.
+static int encode_layer_bindings(zmk_keymap_layer_id_t layer, uint8_t *buf, size_t len) {
+    const struct zmk_behavior_binding *bindings = zmk_keymap[layer];
+    const struct zmk_behavior_binding *stock = zmk_stock_keymap[layer];
+    size_t offset = sizeof(struct layer_bindings_setting_header);
+    uint32_t skipped = 0;
+
+    for (int kp = 0; kp < ZMK_KEYMAP_LEN;) {
+        if (bindings_equal(&bindings[kp], &stock[kp])) {
+            skipped++;
+            kp++;
+            continue;
+        }
+
+        int run_len = 1;
+        while (kp + run_len < ZMK_KEYMAP_LEN &&
+               bindings_equal(&bindings[kp + run_len], &bindings[kp])) {
+            run_len++;
+        }
+
+        const uint32_t entry[LAYER_BINDINGS_ENTRY_FIELDS] = {
+            [LAYER_BINDINGS_ENTRY_SKIP] = skipped,
+            [LAYER_BINDINGS_ENTRY_RUN_LEN] = run_len,
+            [LAYER_BINDINGS_ENTRY_LOCAL_ID] = zmk_behavior_get_local_id(bindings[kp].behavior_dev),
+            [LAYER_BINDINGS_ENTRY_PARAM1] = bindings[kp].param1,
+            [LAYER_BINDINGS_ENTRY_PARAM2] = bindings[kp].param2,
+        };
 
-                WRITE_BIT(pending[kp / 8], kp % 8, 0);
+        for (int i = 0; i < ARRAY_SIZE(entry); i++) {
+            int ret = zmk_varint_encode(entry[i], buf + offset, len - offset);
+            if (ret < 0) {
+                return ret;
             }
+
+            offset += ret;
+        }
+
+        skipped = 0;
+        kp += run_len;
+    }
+
+    struct layer_bindings_setting_header header = {
+        .version = LAYER_BINDINGS_SETTING_VERSION,
+        .keymap_len = ZMK_KEYMAP_LEN,
+        .crc = crc32_ieee(buf + sizeof(header), offset - sizeof(header)),
+    };
+
+    memcpy(buf, &header, sizeof(header));
+
+    return offset;
+}
+
+static void set_binding_from_setting(zmk_keymap_layer_id_t layer, uint32_t key_position,
+                                     zmk_behavior_local_id_t local_id, uint32_t param1,
+                                     uint32_t param2) {
+    const char *name = zmk_behavior_find_behavior_name_from_local_id(local_id);
+
+    if (!name) {
+        LOG_WRN("Loaded device %d from settings but no device found by that local ID", local_id);
+    }
+
+    zmk_keymap[layer][key_position] = (struct zmk_behavior_binding){
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
+        .local_id = local_id,
+#endif
+        .behavior_dev = name,
+        .param1 = param1,
+        .param2 = param2,
+    };
+}
+
+// Walks the runs of a layer bindings setting, and writes them to the layer unless @p validate_only
+// is set.
+static int decode_layer_bindings(zmk_keymap_layer_id_t layer, const uint8_t *buf, size_t len,
+                                 bool validate_only) {
+    uint32_t kp = 0;
+
+    for (size_t offset = sizeof(struct layer_bindings_setting_header); offset < len;) {
+        uint32_t entry[LAYER_BINDINGS_ENTRY_FIELDS];
+
+        for (int i = 0; i < ARRAY_SIZE(entry); i++) {
+            int ret = zmk_varint_decode(buf + offset, len - offset, &entry[i]);
+            if (ret < 0) {
+                return ret;
+            }
+
+            offset += ret;
+        }
+
+        kp += entry[LAYER_BINDINGS_ENTRY_SKIP];
+
+        if (validate_only) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < entry[LAYER_BINDINGS_ENTRY_RUN_LEN] && kp < ZMK_KEYMAP_LEN;
+             i++, kp++) {
+            set_binding_from_setting(layer, kp, entry[LAYER_BINDINGS_ENTRY_LOCAL_ID],
+                                     entry[LAYER_BINDINGS_ENTRY_PARAM1],
+                                     entry[LAYER_BINDINGS_ENTRY_PARAM2]);
+        }
+    }
+
+    return 0;
+}
+
+static int load_layer_bindings(zmk_keymap_layer_id_t layer, const uint8_t *buf, size_t len) {
+    struct layer_bindings_setting_header header;
+
+    if (len < sizeof(header)) {
+        LOG_ERR("Layer %d bindings setting is too short (%d)", layer, len);
+        return -EINVAL;
+    }
+
+    memcpy(&header, buf, sizeof(header));
+
+    if (header.version != LAYER_BINDINGS_SETTING_VERSION) {
+        LOG_ERR("Unsupported layer %d bindings setting version %d", layer, header.version);
+        return -ENOTSUP;
+    }
+
+    if (header.crc != crc32_ieee(buf + sizeof(header), len - sizeof(header))) {
+        LOG_ERR("Layer %d bindings setting is corrupt, ignoring it", layer);
+        return -EILSEQ;
+    }
+
+    if (header.keymap_len != ZMK_KEYMAP_LEN) {
+        LOG_WRN("Layer %d bindings were saved for %d keys, but the keymap has %d", layer,
+                header.keymap_len, ZMK_KEYMAP_LEN);
+    }
+
+    // Check every run before touching the layer, so a malformed setting leaves the bindings that
+    // were loaded before it in place.
+    int ret = decode_layer_bindings(layer, buf, len, true);
+    if (ret < 0) {
+        LOG_ERR("Malformed layer %d bindings setting", layer);
+        return ret;
+    }
+
+    // The layer entry replaces any per-key entries for the layer, even ones loaded before it.
+    memcpy(zmk_keymap[layer], zmk_stock_keymap[layer], sizeof(zmk_keymap[layer]));
+
+    ret = decode_layer_bindings(layer, buf, len, false);
+    if (ret < 0) {
+        return ret;
+    }
+
+    WRITE_BIT(packed_layers, layer, 1);
+    invalidate_binding_cache();
+
+    return 0;
+}
+
+static int save_layer_bindings(zmk_keymap_layer_id_t layer) {
+    char setting_name[14];
+    sprintf(setting_name, LAYER_BINDINGS_SETTINGS_KEY, layer);
+
+    int len = encode_layer_bindings(layer, layer_bindings_buf, sizeof(layer_bindings_buf));
+    if (len < 0) {
+        LOG_ERR("Failed to encode keymap bindings for layer %d (%d)", layer, len);
+        return len;
+    }
+
+    int ret;
+    if (len == sizeof(struct layer_bindings_setting_header)) {
+        ret = settings_delete(setting_name);
+    } else {
+        ret = settings_save_one(setting_name, layer_bindings_buf, len);
+    }
+
+    if (ret < 0) {
+        LOG_ERR("Failed to save keymap bindings for layer %d (%d)", layer, ret);
+        return ret;
+    }
+
+    LOG_DBG("Saved keymap bindings for layer %d in %d bytes", layer, len);
+
+    // Now that the layer entry holds every binding, remove any per-key entries for the layer.
+    uint8_t *legacy = zmk_keymap_layer_legacy_bindings[layer];
+
+    for (int kp = 0; kp < ZMK_KEYMAP_LEN; kp++) {
+        if (legacy[kp / 8] & BIT(kp % 8)) {
+            char binding_setting_name[20];
+            sprintf(binding_setting_name, LAYER_BINDING_SETTINGS_KEY, layer, kp);
+
+            ret = settings_delete(binding_setting_name);
+            if (ret < 0) {
+                LOG_ERR("Failed to delete keymap binding at %d on layer %d (%d)", kp, layer,
+                        ret);
+                return ret;
+            }
+
+            WRITE_BIT(legacy[kp / 8], kp % 8, 0);
+        }
+    }
+
+    memset(zmk_keymap_layer_pending_changes[layer], 0, PENDING_ARRAY_SIZE);
+
+    return 0;
+}
+
+static int save_bindings(void) {
+    for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
+        if (!any_bit_set(zmk_keymap_layer_pending_changes[l]) &&
+            !any_bit_set(zmk_keymap_layer_legacy_bindings[l])) {
+            continue;
+        }
+
+        int ret = save_layer_bindings(l);
+        if (ret < 0) {
+            return ret;
         }
     }
 
@@ -600,6 +907,8 @@ static void load_stock_keymap_layer_ordering() {
         keymap_layer_orders[i] = ZMK_KEYMAP_LAYER_ID_INVAL;
         i++;
     }
+
+    invalidate_binding_cache();
 }
 #endif
 
@@ -609,12 +918,17 @@ static void reload_from_stock_keymap(void) {
             zmk_keymap[l][k] = zmk_stock_keymap[l][k];
         }
     }
+
+    invalidate_binding_cache();
 }
 
 int zmk_keymap_discard_changes(void) {
     load_stock_keymap_layer_ordering();
     reload_from_stock_keymap();
 
+    packed_layers = 0;
+    memset(zmk_keymap_layer_legacy_bindings, 0, sizeof(zmk_keymap_layer_legacy_bindings));
+
     int ret = settings_load_subtree("keymap");
     if (ret >= 0) {
         changed_layer_names = 0;
@@ -665,6 +979,10 @@ int zmk_keymap_reset_settings(void) {
         sprintf(layer_name_setting_name, LAYER_NAME_SETTINGS_KEY, l);
         settings_delete(layer_name_setting_name);
 
+        char layer_bindings_setting_name[14];
+        sprintf(layer_bindings_setting_name, LAYER_BINDINGS_SETTINGS_KEY, l);
+        settings_delete(layer_bindings_setting_name);
+
         uint8_t *changes = zmk_keymap_layer_changes[l];
 
         for (int k = 0; k < ZMK_KEYMAP_LEN; k++) {
@@ -682,6 +1000,9 @@ int zmk_keymap_reset_settings(void) {
         }
     }
 
+    packed_layers = 0;
+    memset(zmk_keymap_layer_legacy_bindings, 0, sizeof(zmk_keymap_layer_legacy_bindings));
+
     load_stock_keymap_layer_ordering();
 
     reload_from_stock_keymap();
@@ -699,10 +1020,9 @@ int zmk_keymap_reset_settings(void) { return -ENOTSUP; }
 
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_SETTINGS_STORAGE)
 
-int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_id,
-                                    uint32_t position, bool pressed, int64_t timestamp) {
-    const struct zmk_behavior_binding *binding =
-        zmk_keymap_get_layer_binding_at_idx(layer_id, position);
+static int invoke_layer_binding(uint8_t source, zmk_keymap_layer_id_t layer_id,
+                                const struct zmk_behavior_binding *binding, uint32_t position,
+                                bool pressed, int64_t timestamp) {
     struct zmk_behavior_binding_event event = {
         .layer = layer_id,
         .position = position,
@@ -718,14 +1038,17 @@ int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_
     return zmk_behavior_invoke_binding(binding, event, pressed);
 }
 
-int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pressed,
-                                      int64_t timestamp) {
-    if (pressed) {
-        zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
-    }
+int zmk_keymap_apply_position_state(uint8_t source, zmk_keymap_layer_id_t layer_id,
+                                    uint32_t position, bool pressed, int64_t timestamp) {
+    return invoke_layer_binding(source, layer_id,
+                                zmk_keymap_get_layer_binding_at_idx(layer_id, position), position,
+                                pressed, timestamp);
+}
 
+static int position_state_changed_from(uint8_t source, uint32_t position, bool pressed,
+                                       int64_t timestamp, int start_idx) {
     // We use int here to be sure we don't loop layer_idx back to UINT8_MAX
-    for (int layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+    for (int layer_idx = MIN(start_idx, ZMK_KEYMAP_LAYERS_LEN - 1);
          layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default); layer_idx--) {
         zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
 
@@ -751,6 +1074,131 @@ int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pr
     return -ENOTSUP;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
+static bool binding_is_transparent(const struct zmk_behavior_binding *binding) {
+    if (!binding) {
+        return false;
+    }
+
+    const struct device *dev = zmk_behavior_get_binding_device(binding);
+
+    for (int i = 0; i < ARRAY_SIZE(transparent_behaviors); i++) {
+        if (dev == transparent_behaviors[i]) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void refresh_binding_cache_chain(zmk_keymap_layers_state_t state) {
+    if (binding_cache_chain_valid && binding_cache_state == state) {
+        return;
+    }
+
+    invalidate_binding_cache();
+
+    binding_cache_chain_len = 0;
+    for (int layer_idx = ZMK_KEYMAP_LAYERS_LEN - 1;
+         layer_idx >= LAYER_ID_TO_INDEX(_zmk_keymap_layer_default); layer_idx--) {
+        zmk_keymap_layer_id_t layer_id = LAYER_INDEX_TO_ID(layer_idx);
+
+        if (layer_id != ZMK_KEYMAP_LAYER_ID_INVAL &&
+            zmk_keymap_layer_active_with_state(layer_id, state)) {
+            binding_cache_chain[binding_cache_chain_len++] = layer_id;
+        }
+    }
+
+    binding_cache_state = state;
+    binding_cache_chain_valid = true;
+}
+
+static const struct binding_cache_entry *get_binding_cache_entry(uint32_t position) {
+    struct binding_cache_entry *entry = &binding_cache[position];
+
+    if (entry->generation == binding_cache_generation) {
+        return entry;
+    }
+
+    // Transparent bindings would only send us on to the next layer, so skip straight past them.
+    entry->binding = NULL;
+    for (entry->chain_idx = 0; entry->chain_idx < binding_cache_chain_len; entry->chain_idx++) {
+        const struct zmk_behavior_binding *binding = zmk_keymap_get_layer_binding_at_idx(
+            binding_cache_chain[entry->chain_idx], position);
+
+        if (!binding_is_transparent(binding)) {
+            entry->binding = binding;
+            break;
+        }
+    }
+
+    entry->generation = binding_cache_generation;
+
+    return entry;
+}
+
+static int position_state_changed_cached(uint8_t source, uint32_t position, bool pressed,
+                                         int64_t timestamp) {
+    const struct binding_cache_entry *entry = get_binding_cache_entry(position);
+    const struct zmk_behavior_binding *binding = entry->binding;
+    uint16_t generation = binding_cache_generation;
+
+    for (uint8_t idx = entry->chain_idx; idx < binding_cache_chain_len; idx++) {
+        zmk_keymap_layer_id_t layer_id = binding_cache_chain[idx];
+
+        if (!binding) {
+            binding = zmk_keymap_get_layer_binding_at_idx(layer_id, position);
+        }
+
+        int ret = invoke_layer_binding(source, layer_id, binding, position, pressed, timestamp);
+        if (ret < 0) {
+            LOG_DBG("Behavior returned error: %d", ret);
+            return ret;
+        } else if (ret == 0) {
+            return ret;
+        }
+
+        LOG_DBG("behavior processing to continue to next layer");
+
+        // The behavior may have changed the layers or bindings, in which case the rest of the
+        // chain can no longer be trusted.
+        if (generation != binding_cache_generation) {
+            return position_state_changed_from(source, position, pressed, timestamp,
+                                               LAYER_ID_TO_INDEX(layer_id) - 1);
+        }
+
+        binding = NULL;
+    }
+
+    return -ENOTSUP;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+
+int zmk_keymap_position_state_changed(uint8_t source, uint32_t position, bool pressed,
+                                      int64_t timestamp) {
+    if (pressed) {
+        zmk_keymap_active_behavior_layer[position] = _zmk_keymap_layer_state;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    // Releases of keys pressed with a different layer state than the current one are rare, and
+    // aren't worth evicting the chain for.
+    if (pressed) {
+        refresh_binding_cache_chain(_zmk_keymap_layer_state);
+    }
+
+    if (binding_cache_chain_valid &&
+        binding_cache_state == zmk_keymap_active_behavior_layer[position]) {
+        return position_state_changed_cached(source, position, pressed, timestamp);
+    }
+#endif
+
+    return position_state_changed_from(source, position, pressed, timestamp,
+                                       ZMK_KEYMAP_LAYERS_LEN - 1);
+}
+
 #if ZMK_KEYMAP_HAS_SENSORS
 int zmk_keymap_sensor_event(uint8_t sensor_index,
                             const struct zmk_sensor_channel_data *channel_data,
@@ -829,12 +1277,24 @@ int keymap_listener(const zmk_event_t *eh) {
     }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+    if (as_zmk_physical_layout_selection_changed(eh) != NULL) {
+        // The bindings for each key position depend on the selected layout's position map.
+        invalidate_binding_cache();
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+#endif
+
     return -ENOTSUP;
 }
 
 ZMK_LISTENER(keymap, keymap_listener);
 ZMK_SUBSCRIPTION(keymap, zmk_position_state_changed);
 
+#if IS_ENABLED(CONFIG_ZMK_KEYMAP_BINDING_CACHE)
+ZMK_SUBSCRIPTION(keymap, zmk_physical_layout_selection_changed);
+#endif
+
 #if ZMK_KEYMAP_HAS_SENSORS
 ZMK_SUBSCRIPTION(keymap, zmk_sensor_event);
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
@@ -867,6 +1327,35 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
         }
 
         zmk_keymap_layer_names[layer][ret] = 0;
+    } else if (settings_name_steq(name, "lb", &next) && next) {
+        char *endptr;
+        uint8_t layer = strtoul(next, &endptr, 10);
+        if (*endptr != '\0') {
+            LOG_WRN("Invalid layer number: %s with endptr %s", next, endptr);
+            return -EINVAL;
+        }
+
+        if (layer >= ZMK_KEYMAP_LAYERS_LEN) {
+            LOG_WRN("Layer %d is larger than max of %d", layer, ZMK_KEYMAP_LAYERS_LEN);
+            return -EINVAL;
+        }
+
+        if (len > sizeof(layer_bindings_buf)) {
+            LOG_ERR("Too large layer bindings setting size (got %d max %d)", len,
+                    sizeof(layer_bindings_buf));
+            return -EINVAL;
+        }
+
+        int ret = read_cb(cb_arg, layer_bindings_buf, len);
+        if (ret <= 0) {
+            LOG_ERR("Failed to handle keymap layer bindings from settings (err %d)", ret);
+            return ret;
+        }
+
+        ret = load_layer_bindings(layer, layer_bindings_buf, ret);
+        if (ret < 0) {
+            return ret;
+        }
     } else if (settings_name_steq(name, "l", &next) && next) {
         char *endptr;
         uint8_t layer = strtoul(next, &endptr, 10);
@@ -898,6 +1387,13 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
             return -EINVAL;
         }
 
+        WRITE_BIT(zmk_keymap_layer_legacy_bindings[layer][key_position / 8], key_position % 8, 1);
+
+        if (packed_layers & BIT(layer)) {
+            // Left behind by an interrupted save. The layer entry takes precedence.
+            return 0;
+        }
+
         struct zmk_behavior_binding_setting binding_setting = {0};
         int err = read_cb(cb_arg, &binding_setting, len);
         if (err <= 0) {
@@ -905,22 +1401,10 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
             return err;
         }
 
-        const char *name =
-            zmk_behavior_find_behavior_name_from_local_id(binding_setting.behavior_local_id);
-
-        if (!name) {
-            LOG_WRN("Loaded device %d from settings but no device found by that local ID",
-                    binding_setting.behavior_local_id);
-        }
+        set_binding_from_setting(layer, key_position, binding_setting.behavior_local_id,
+                                 binding_setting.param1, binding_setting.param2);
 
-        zmk_keymap[layer][key_position] = (struct zmk_behavior_binding){
-#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
-            .local_id = binding_setting.behavior_local_id,
-#endif
-            .behavior_dev = name,
-            .param1 = binding_setting.param1,
-            .param2 = binding_setting.param2,
-        };
+        invalidate_binding_cache();
     }
 #if IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
     else if (settings_name_steq(name, "layer_order", &next) && !next) {
@@ -936,6 +1420,8 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 
         memcpy(keymap_layer_orders, settings_layer_orders,
                MIN(len, ARRAY_SIZE(settings_layer_orders)));
+
+        invalidate_binding_cache();
     }
 #endif // IS_ENABLED(CONFIG_ZMK_KEYMAP_LAYER_REORDERING)
 
@@ -943,11 +1429,11 @@ static int keymap_handle_set(const char *name, size_t len, settings_read_cb read
 };
 
 static int keymap_handle_commit(void) {
-#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
     for (int l = 0; l < ZMK_KEYMAP_LAYERS_LEN; l++) {
         for (int p = 0; p < ZMK_KEYMAP_LEN; p++) {
             struct zmk_behavior_binding *binding = &zmk_keymap[l][p];
 
+#if IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_IDS_IN_BINDINGS)
             if (binding->local_id > 0 && !binding->behavior_dev) {
                 binding->behavior_dev =
                     zmk_behavior_find_behavior_name_from_local_id(binding->local_id);
@@ -957,9 +1443,15 @@ static int keymap_handle_commit(void) {
                             binding->local_id);
                 }
             }
+#endif
+
+            if (!binding->device && binding->behavior_dev) {
+                binding->device = zmk_behavior_get_binding(binding->behavior_dev);
+            }
         }
     }
-#endif
+
+    invalidate_binding_cache();
 
     return 0;
 }
@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/logging/log.h>
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#include <zmk/latency.h>
+
+#define HISTORY_SIZE CONFIG_ZMK_LATENCY_TRACING_HISTORY_SIZE
+
+struct latency_record {
+    uint32_t stamps[ZMK_LATENCY_STAGE_COUNT];
+    uint8_t stages;
+};
+
+static const char *const stage_names[ZMK_LATENCY_STAGE_COUNT] = {
+    [ZMK_LATENCY_STAGE_KSCAN_CAPTURE] = "capture",
+    [ZMK_LATENCY_STAGE_MSGQ_DEQUEUE] = "dequeue",
+    [ZMK_LATENCY_STAGE_POSITION_RAISED] = "position",
+    [ZMK_LATENCY_STAGE_BEHAVIOR_INVOKED] = "behavior",
+    [ZMK_LATENCY_STAGE_HID_LISTENER] = "hid",
+    [ZMK_LATENCY_STAGE_REPORT_SENT] = "sent",
+    [ZMK_LATENCY_STAGE_REPORT_DELIVERED] = "delivered",
+};
+
+static struct k_spinlock lock;
+
+static struct latency_record history[HISTORY_SIZE];
+static size_t history_next;
+static size_t history_len;
+
+static struct latency_record current;
+static k_tid_t current_thread;
+
+// The most recently finished trace which sent a report that hasn't been delivered yet.
+static struct latency_record *awaiting_delivery;
+
+static inline void stamp(struct latency_record *record, enum zmk_latency_stage stage,
+                         uint32_t cycles) {
+    if (record->stages & BIT(stage)) {
+        return;
+    }
+
+    record->stamps[stage] = cycles;
+    record->stages |= BIT(stage);
+}
+
+static inline uint32_t stage_us(const struct latency_record *record,
+                                enum zmk_latency_stage stage) {
+    return k_cyc_to_us_floor32(record->stamps[stage] -
+                               record->stamps[ZMK_LATENCY_STAGE_KSCAN_CAPTURE]);
+}
+
+const char *zmk_latency_stage_name(enum zmk_latency_stage stage) {
+    if (stage >= ZMK_LATENCY_STAGE_COUNT) {
+        return NULL;
+    }
+
+    return stage_names[stage];
+}
+
+void zmk_latency_trace_begin(uint32_t capture_cycles) {
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    current = (struct latency_record){0};
+    stamp(&current, ZMK_LATENCY_STAGE_KSCAN_CAPTURE, capture_cycles);
+    stamp(&current, ZMK_LATENCY_STAGE_MSGQ_DEQUEUE, now);
+    current_thread = k_current_get();
+
+    k_spin_unlock(&lock, key);
+}
+
+void zmk_latency_trace_mark(enum zmk_latency_stage stage) {
+    if (current_thread != k_current_get() || stage >= ZMK_LATENCY_STAGE_COUNT) {
+        return;
+    }
+
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    stamp(&current, stage, now);
+    k_spin_unlock(&lock, key);
+}
+
+void zmk_latency_trace_end(void) {
+    if (current_thread != k_current_get()) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    struct latency_record *record = &history[history_next];
+    *record = current;
+    current_thread = NULL;
+
+    history_next = (history_next + 1) % HISTORY_SIZE;
+    history_len = MIN(history_len + 1, HISTORY_SIZE);
+
+    bool sent = record->stages & BIT(ZMK_LATENCY_STAGE_REPORT_SENT);
+    bool delivered = record->stages & BIT(ZMK_LATENCY_STAGE_REPORT_DELIVERED);
+    awaiting_delivery = (sent && !delivered) ? record : NULL;
+
+    k_spin_unlock(&lock, key);
+
+    if (record->stages & BIT(ZMK_LATENCY_STAGE_REPORT_SENT)) {
+        LOG_DBG("Key event latency: %u us to report sent",
+                stage_us(record, ZMK_LATENCY_STAGE_REPORT_SENT));
+    }
+}
+
+void zmk_latency_report_delivered(void) {
+    uint32_t now = k_cycle_get_32();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    if (current_thread && (current.stages & BIT(ZMK_LATENCY_STAGE_REPORT_SENT))) {
+        stamp(&current, ZMK_LATENCY_STAGE_REPORT_DELIVERED, now);
+    } else if (awaiting_delivery) {
+        stamp(awaiting_delivery, ZMK_LATENCY_STAGE_REPORT_DELIVERED, now);
+        awaiting_delivery = NULL;
+    }
+
+    k_spin_unlock(&lock, key);
+}
+
+static void sort_samples(uint32_t *samples, size_t len) {
+    for (size_t i = 1; i < len; i++) {
+        uint32_t val = samples[i];
+        size_t j = i;
+
+        for (; j > 0 && samples[j - 1] > val; j--) {
+            samples[j] = samples[j - 1];
+        }
+
+        samples[j] = val;
+    }
+}
+
+static inline uint32_t percentile(const uint32_t *sorted, size_t len, uint8_t pct) {
+    return sorted[((len - 1) * pct) / 100];
+}
+
+int zmk_latency_get_stats(enum zmk_latency_stage stage, struct zmk_latency_stats *stats) {
+    if (stage >= ZMK_LATENCY_STAGE_COUNT) {
+        return -EINVAL;
+    }
+
+    uint32_t samples[HISTORY_SIZE];
+    size_t count = 0;
+    uint8_t needed = BIT(ZMK_LATENCY_STAGE_KSCAN_CAPTURE) | BIT(stage);
+
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    for (size_t i = 0; i < history_len; i++) {
+        if ((history[i].stages & needed) == needed) {
+            samples[count++] = stage_us(&history[i], stage);
+        }
+    }
+
+    k_spin_unlock(&lock, key);
+
+    if (count == 0) {
+        return -ENODATA;
+    }
+
+    sort_samples(samples, count);
+
+    *stats = (struct zmk_latency_stats){
+        .count = count,
+        .min_us = samples[0],
+        .p50_us = percentile(samples, count, 50),
+        .p90_us = percentile(samples, count, 90),
+        .p99_us = percentile(samples, count, 99),
+        .max_us = samples[count - 1],
+    };
+
+    return 0;
+}
+
+void zmk_latency_reset(void) {
+    k_spinlock_key_t key = k_spin_lock(&lock);
+
+    history_next = 0;
+    history_len = 0;
+    awaiting_delivery = NULL;
+
+    k_spin_unlock(&lock, key);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING_SHELL)
+
+static int cmd_latency_show(const struct shell *sh, size_t argc, char **argv) {
+    shell_print(sh, "%-10s %5s %8s %8s %8s %8s %8s", "stage", "n", "min", "p50", "p90", "p99",
+                "max");
+
+    for (int s = ZMK_LATENCY_STAGE_MSGQ_DEQUEUE; s < ZMK_LATENCY_STAGE_COUNT; s++) {
+        struct zmk_latency_stats stats;
+        if (zmk_latency_get_stats(s, &stats) < 0) {
+            shell_print(sh, "%-10s %5d", stage_names[s], 0);
+            continue;
+        }
+
+        shell_print(sh, "%-10s %5u %8u %8u %8u %8u %8u", stage_names[s], stats.count,
+                    stats.min_us, stats.p50_us, stats.p90_us, stats.p99_us, stats.max_us);
+    }
+
+    shell_print(sh, "All times are in microseconds since the key change was captured");
+
+    return 0;
+}
+
+static int cmd_latency_reset(const struct shell *sh, size_t argc, char **argv) {
+    zmk_latency_reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_latency,
+                               SHELL_CMD(show, NULL, "Show per-stage latency percentiles",
+                                         cmd_latency_show),
+                               SHELL_CMD(reset, NULL, "Clear the latency history",
+                                         cmd_latency_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(latency, &sub_latency, "Keypress latency tracing", NULL);
+
+#endif // IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING_SHELL)
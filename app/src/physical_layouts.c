@@ -19,10 +19,17 @@
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
+#include <zmk/debounce.h>
 #include <zmk/matrix.h>
 #include <zmk/physical_layouts.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
+#include <zmk/timer_wheel.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+#include <zmk/latency.h>
+#endif
 
 ZMK_EVENT_IMPL(zmk_physical_layout_selection_changed);
 
@@ -205,6 +212,11 @@ struct zmk_kscan_event {
     uint32_t row;
     uint32_t column;
     uint32_t state;
+    /** Uptime in milliseconds when the key changed state. */
+    int64_t timestamp;
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    uint32_t capture_cycles;
+#endif
 };
 
 static struct zmk_kscan_msg_processor {
@@ -214,9 +226,96 @@ static struct zmk_kscan_msg_processor {
 K_MSGQ_DEFINE(physical_layouts_kscan_msgq, sizeof(struct zmk_kscan_event),
               CONFIG_ZMK_KSCAN_EVENT_QUEUE_SIZE, 4);
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_DEBOUNCE_TIMESTAMP_CORRECTION)
+
+#if defined(CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS) && CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS >= 0
+#define KSCAN_DEBOUNCE_PRESS_PERIOD_MS(node)                                                       \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, debounce_press_ms), (CONFIG_ZMK_KSCAN_DEBOUNCE_PRESS_MS),   \
+                (DT_PROP_OR(node, debounce_period, 0)))
+#else
+#define KSCAN_DEBOUNCE_PRESS_PERIOD_MS(node)                                                       \
+    DT_PROP_OR(node, debounce_period, DT_PROP_OR(node, debounce_press_ms, 0))
+#endif
+
+#if defined(CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS) && CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS >= 0
+#define KSCAN_DEBOUNCE_RELEASE_PERIOD_MS(node)                                                     \
+    COND_CODE_1(DT_NODE_HAS_PROP(node, debounce_release_ms),                                       \
+                (CONFIG_ZMK_KSCAN_DEBOUNCE_RELEASE_MS), (DT_PROP_OR(node, debounce_period, 0)))
+#else
+#define KSCAN_DEBOUNCE_RELEASE_PERIOD_MS(node)                                                     \
+    DT_PROP_OR(node, debounce_period, DT_PROP_OR(node, debounce_release_ms, 0))
+#endif
+
+#define KSCAN_DEBOUNCE_ALGORITHM(node)                                                             \
+    DT_ENUM_IDX_OR(node, debounce_algorithm, ZMK_DEBOUNCE_INTEGRATOR)
+
+// Eager press and lockout debouncing latch a press on its first read, as lockout also does with a
+// release, so there is no delay to correct for on those changes.
+#define KSCAN_DEBOUNCE_PRESS_MS(node)                                                              \
+    ((KSCAN_DEBOUNCE_ALGORITHM(node) == ZMK_DEBOUNCE_EAGER_PRESS ||                                \
+      KSCAN_DEBOUNCE_ALGORITHM(node) == ZMK_DEBOUNCE_LOCKOUT)                                      \
+         ? 0                                                                                       \
+         : KSCAN_DEBOUNCE_PRESS_PERIOD_MS(node))
+
+#define KSCAN_DEBOUNCE_RELEASE_MS(node)                                                            \
+    (KSCAN_DEBOUNCE_ALGORITHM(node) == ZMK_DEBOUNCE_LOCKOUT                                        \
+         ? 0                                                                                       \
+         : KSCAN_DEBOUNCE_RELEASE_PERIOD_MS(node))
+
+struct kscan_debounce_delay {
+    const struct device *kscan;
+    uint16_t press_ms;
+    uint16_t release_ms;
+};
+
+#define KSCAN_DEBOUNCE_DELAY(node)                                                                 \
+    {                                                                                              \
+        .kscan = DEVICE_DT_GET(node),                                                              \
+        .press_ms = KSCAN_DEBOUNCE_PRESS_MS(node),                                                 \
+        .release_ms = KSCAN_DEBOUNCE_RELEASE_MS(node),                                             \
+    },
+
+// Debounce delays for the kscan drivers which debounce with zmk/debounce.h. Other drivers report
+// keys as soon as they change, or debounce in a way we can't account for. The demux driver's
+// debounce-period only delays reading the matrix after an interrupt, so it isn't included.
+static const struct kscan_debounce_delay kscan_debounce_delays[] = {
+    DT_FOREACH_STATUS_OKAY(zmk_kscan_gpio_matrix, KSCAN_DEBOUNCE_DELAY)
+        DT_FOREACH_STATUS_OKAY(zmk_kscan_gpio_direct, KSCAN_DEBOUNCE_DELAY)
+            DT_FOREACH_STATUS_OKAY(zmk_kscan_gpio_charlieplex, KSCAN_DEBOUNCE_DELAY)};
+
+static struct kscan_debounce_delay active_debounce_delay;
+
+static void update_active_debounce_delay(const struct device *kscan) {
+    active_debounce_delay = (struct kscan_debounce_delay){.kscan = kscan};
+
+    for (int i = 0; i < ARRAY_SIZE(kscan_debounce_delays); i++) {
+        if (kscan_debounce_delays[i].kscan == kscan) {
+            active_debounce_delay = kscan_debounce_delays[i];
+            break;
+        }
+    }
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_KSCAN_DEBOUNCE_TIMESTAMP_CORRECTION)
+
+/**
+ * Get the timestamp for a key which the kscan driver just reported as changed.
+ */
+static int64_t kscan_event_timestamp(bool pressed) {
+    int64_t timestamp = k_uptime_get();
+
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_DEBOUNCE_TIMESTAMP_CORRECTION)
+    // The key changed state when the debouncer first saw it, not when it latched.
+    timestamp -= pressed ? active_debounce_delay.press_ms : active_debounce_delay.release_ms;
+#endif
+
+    return timestamp;
+}
+
 #if MATRIX_INPUT_SUPPORT
 
 static struct zmk_kscan_event pending_input_event;
+static bool pending_input_event_started;
 
 static void zmk_physical_layout_input_event_cb(struct input_event *evt, void *user_data) {
     const struct zmk_physical_layout *layout = (const struct zmk_physical_layout *)user_data;
@@ -225,6 +324,12 @@ static void zmk_physical_layout_input_event_cb(struct input_event *evt, void *us
         return;
     }
 
+    // All the events up to the sync describe one key change, so use the time of the first.
+    if (!pending_input_event_started) {
+        pending_input_event.timestamp = k_uptime_get();
+        pending_input_event_started = true;
+    }
+
     switch (evt->type) {
     case INPUT_EV_ABS:
         switch (evt->code) {
@@ -256,8 +361,12 @@ static void zmk_physical_layout_input_event_cb(struct input_event *evt, void *us
     }
 
     if (evt->sync) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+        pending_input_event.capture_cycles = zmk_latency_now();
+#endif
+        pending_input_event_started = false;
         k_msgq_put(&physical_layouts_kscan_msgq, &pending_input_event, K_NO_WAIT);
-        k_work_submit(&msg_processor.work);
+        k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &msg_processor.work);
     }
 }
 
@@ -272,16 +381,28 @@ static void zmk_physical_layout_kscan_callback(const struct device *dev, uint32_
     struct zmk_kscan_event ev = {
         .row = row,
         .column = column,
-        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED)};
+        .state = (pressed ? ZMK_KSCAN_EVENT_STATE_PRESSED : ZMK_KSCAN_EVENT_STATE_RELEASED),
+        .timestamp = kscan_event_timestamp(pressed),
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+        .capture_cycles = zmk_latency_now(),
+#endif
+    };
 
     k_msgq_put(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&msg_processor.work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &msg_processor.work);
 }
 
 static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
+    // Different debounce delays for presses and releases could otherwise put an event's timestamp
+    // before that of one raised ahead of it.
+    static int64_t last_timestamp;
     struct zmk_kscan_event ev;
 
     while (k_msgq_get(&physical_layouts_kscan_msgq, &ev, K_NO_WAIT) == 0) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+        zmk_latency_trace_begin(ev.capture_cycles);
+#endif
+
         bool pressed = (ev.state == ZMK_KSCAN_EVENT_STATE_PRESSED);
         int32_t position = zmk_matrix_transform_row_column_to_position(active->matrix_transform,
                                                                        ev.row, ev.column);
@@ -289,16 +410,30 @@ static void zmk_physical_layouts_kscan_process_msgq(struct k_work *item) {
         if (position < 0) {
             LOG_WRN("Not found in transform: row: %d, col: %d, pressed: %s", ev.row, ev.column,
                     (pressed ? "true" : "false"));
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+            zmk_latency_trace_end();
+#endif
             continue;
         }
 
+        last_timestamp = MAX(ev.timestamp, last_timestamp);
+
         LOG_DBG("Row: %d, col: %d, position: %d, pressed: %s", ev.row, ev.column, position,
                 (pressed ? "true" : "false"));
+        // Any timeout which should have happened before this key change must be handled first.
+        zmk_timer_wheel_expire(last_timestamp);
+
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+        zmk_latency_trace_mark(ZMK_LATENCY_STAGE_POSITION_RAISED);
+#endif
         raise_zmk_position_state_changed(
             (struct zmk_position_state_changed){.source = ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL,
                                                 .state = pressed,
                                                 .position = position,
-                                                .timestamp = k_uptime_get()});
+                                                .timestamp = last_timestamp});
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+        zmk_latency_trace_end();
+#endif
     }
 }
 
@@ -362,6 +497,10 @@ int zmk_physical_layouts_select_layout(const struct zmk_physical_layout *dest_la
 
     active = dest_layout;
 
+#if IS_ENABLED(CONFIG_ZMK_KSCAN_DEBOUNCE_TIMESTAMP_CORRECTION)
+    update_active_debounce_delay(active->kscan);
+#endif
+
     if (active->kscan) {
 #if IS_ENABLED(CONFIG_PM_DEVICE_RUNTIME)
         int err = pm_device_runtime_get(active->kscan);
@@ -27,6 +27,14 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/hid.h>
 #include <zmk/keymap.h>
 
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+#include <zmk/pointing/report_accumulator.h>
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+#include <zmk/pointing/input_processor_ops.h>
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+
 #define ONE_IF_DEV_OK(n)                                                                           \
     COND_CODE_1(DT_NODE_HAS_STATUS(DT_INST_PHANDLE(n, device), okay), (1 +), (0 +))
 
@@ -41,7 +49,7 @@ enum input_listener_xy_data_mode {
 };
 
 struct input_listener_axis_data {
-    int16_t value;
+    int32_t value;
 };
 
 struct input_listener_xy_data {
@@ -50,9 +58,25 @@ struct input_listener_xy_data {
     struct input_listener_axis_data y;
 };
 
+struct input_processor_remainder_data {
+    int16_t x, y, wheel, h_wheel;
+};
+
+struct input_listener_processor_data {
+    size_t remainders_len;
+    struct input_processor_remainder_data *remainders;
+};
+
 struct input_listener_config_entry {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+    // Runs the whole processor list, generated from devicetree with the processors' properties and
+    // parameters built in.
+    int (*fused)(uint8_t listener_index, struct input_listener_processor_data *processor_data,
+                 struct input_event *evt);
+#else
     size_t processors_len;
     const struct zmk_input_processor_entry *processors;
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
 };
 
 struct input_listener_layer_override {
@@ -61,15 +85,6 @@ struct input_listener_layer_override {
     struct input_listener_config_entry config;
 };
 
-struct input_processor_remainder_data {
-    int16_t x, y, wheel, h_wheel;
-};
-
-struct input_listener_processor_data {
-    size_t remainders_len;
-    struct input_processor_remainder_data *remainders;
-};
-
 struct input_listener_config {
     uint8_t listener_index;
     struct input_listener_config_entry base;
@@ -161,35 +176,38 @@ static inline bool is_y_data(const struct input_event *evt) {
     return evt->type == INPUT_EV_REL && evt->code == INPUT_REL_Y;
 }
 
+static inline int16_t *remainder_for(struct input_processor_remainder_data *remainders,
+                                     const struct input_event *evt) {
+    if (evt->type != INPUT_EV_REL) {
+        return NULL;
+    }
+
+    switch (evt->code) {
+    case INPUT_REL_X:
+        return &remainders->x;
+    case INPUT_REL_Y:
+        return &remainders->y;
+    case INPUT_REL_WHEEL:
+        return &remainders->wheel;
+    case INPUT_REL_HWHEEL:
+        return &remainders->h_wheel;
+    default:
+        return NULL;
+    }
+}
+
 static int apply_config(uint8_t listener_index, const struct input_listener_config_entry *cfg,
                         struct input_listener_processor_data *processor_data,
                         struct input_listener_data *data, struct input_event *evt) {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+    return cfg->fused(listener_index, processor_data, evt);
+#else
     size_t remainder_index = 0;
     for (size_t p = 0; p < cfg->processors_len; p++) {
         const struct zmk_input_processor_entry *proc_e = &cfg->processors[p];
-        struct input_processor_remainder_data *remainders = NULL;
-        if (proc_e->track_remainders) {
-            remainders = &processor_data->remainders[remainder_index++];
-        }
-
         int16_t *remainder = NULL;
-        if (remainders) {
-            if (evt->type == INPUT_EV_REL) {
-                switch (evt->code) {
-                case INPUT_REL_X:
-                    remainder = &remainders->x;
-                    break;
-                case INPUT_REL_Y:
-                    remainder = &remainders->y;
-                    break;
-                case INPUT_REL_WHEEL:
-                    remainder = &remainders->wheel;
-                    break;
-                case INPUT_REL_HWHEEL:
-                    remainder = &remainders->h_wheel;
-                    break;
-                }
-            }
+        if (proc_e->track_remainders) {
+            remainder = remainder_for(&processor_data->remainders[remainder_index++], evt);
         }
 
         LOG_DBG("LISTENER INDEX: %d", listener_index);
@@ -207,6 +225,7 @@ static int apply_config(uint8_t listener_index, const struct input_listener_conf
     }
 
     return ZMK_INPUT_PROC_CONTINUE;
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
 }
 
 static int filter_with_input_config(const struct input_listener_config *cfg,
@@ -300,6 +319,18 @@ static void input_handler(const struct input_listener_config *config,
     }
 
     if (evt->sync) {
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+        zmk_pointing_report_accumulate(&(struct zmk_pointing_report_delta){
+            .movement = data->mouse.data.mode == INPUT_LISTENER_XY_DATA_MODE_REL,
+            .scroll = data->mouse.wheel_data.mode == INPUT_LISTENER_XY_DATA_MODE_REL,
+            .x = data->mouse.data.x.value,
+            .y = data->mouse.data.y.value,
+            .scroll_x = data->mouse.wheel_data.x.value,
+            .scroll_y = data->mouse.wheel_data.y.value,
+            .button_set = data->mouse.button_set,
+            .button_clear = data->mouse.button_clear,
+        });
+#else
         if (data->mouse.wheel_data.mode == INPUT_LISTENER_XY_DATA_MODE_REL) {
             zmk_hid_mouse_scroll_set(data->mouse.wheel_data.x.value,
                                      data->mouse.wheel_data.y.value);
@@ -328,6 +359,7 @@ static void input_handler(const struct input_listener_config *config,
         zmk_endpoint_send_mouse_report();
         zmk_hid_mouse_scroll_set(0, 0);
         zmk_hid_mouse_movement_set(0, 0);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
 
         clear_xy_data(&data->mouse.data);
         clear_xy_data(&data->mouse.wheel_data);
@@ -342,11 +374,94 @@ static void input_handler(const struct input_listener_config *config,
     +DT_PROP(DT_PHANDLE_BY_IDX(n, input_processors, idx), track_remainders)
 #define PROCESSOR_REM_TRACKERS(n) (0 DT_FOREACH_PROP_ELEM(n, input_processors, ONE_FOR_TRACKED))
 
-#define SCOPED_PROCESSOR(scope, n, id)                                                             \
+#define PROCESSOR_REMAINDERS(scope, n, id)                                                         \
     COND_CODE_1(DT_NODE_HAS_PROP(n, input_processors),                                             \
                 (static struct input_processor_remainder_data _CONCAT(                             \
                      input_processor_remainders_##id, scope)[PROCESSOR_REM_TRACKERS(n)] = {};),    \
-                ())                                                                                \
+                ())
+
+#if IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+
+#define FUSED_PARAM(n, idx, cell)                                                                  \
+    COND_CODE_0(DT_PHA_HAS_CELL_AT_IDX(n, input_processors, idx, cell), (0),                       \
+                (DT_PHA_BY_IDX(n, input_processors, idx, cell)))
+
+#define FUSED_SCALER(node, n, idx)                                                                 \
+    if (evt->type == DT_PROP_OR(node, type, INPUT_EV_REL)) {                                       \
+        static const uint16_t codes[] = DT_PROP(node, codes);                                      \
+        if (zmk_input_processor_code_idx(evt->code, codes, ARRAY_SIZE(codes)) >= 0) {              \
+            zmk_input_processor_scale(evt, FUSED_PARAM(n, idx, param1),                            \
+                                      FUSED_PARAM(n, idx, param2), remainder);                     \
+        }                                                                                          \
+    }
+
+#define FUSED_TRANSFORM(node, n, idx)                                                              \
+    if (evt->type == DT_PROP_OR(node, type, INPUT_EV_REL)) {                                       \
+        static const uint16_t x_codes[] = DT_PROP(node, x_codes);                                  \
+        static const uint16_t y_codes[] = DT_PROP(node, y_codes);                                  \
+        zmk_input_processor_transform(evt, FUSED_PARAM(n, idx, param1), x_codes,                   \
+                                      ARRAY_SIZE(x_codes), y_codes, ARRAY_SIZE(y_codes));          \
+    }
+
+#define FUSED_CODE_MAPPER(node, n, idx)                                                            \
+    if (evt->type == DT_PROP_OR(node, type, INPUT_EV_REL)) {                                       \
+        static const uint16_t map[] = DT_PROP(node, map);                                          \
+        zmk_input_processor_map_code(evt, map, ARRAY_SIZE(map));                                   \
+    }
+
+// Processors with state or side effects, e.g. temp layers, are still called through their devices.
+#define FUSED_DEVICE(node, n, idx)                                                                 \
+    {                                                                                              \
+        struct zmk_input_processor_state state = {.input_device_index = listener_index,           \
+                                                  .remainder = remainder};                         \
+        int ret = zmk_input_processor_handle_event(DEVICE_DT_GET(node), evt,                       \
+                                                   FUSED_PARAM(n, idx, param1),                    \
+                                                   FUSED_PARAM(n, idx, param2), &state);           \
+        if (ret != ZMK_INPUT_PROC_CONTINUE) {                                                      \
+            return ret;                                                                            \
+        }                                                                                          \
+    }
+
+#define FUSED_STEP_FOR(node, n, idx)                                                               \
+    {                                                                                              \
+        int16_t *remainder = COND_CODE_1(                                                          \
+            DT_PROP(node, track_remainders),                                                       \
+            (remainder_for(&processor_data->remainders[remainder_index++], evt)), (NULL));         \
+        ARG_UNUSED(remainder);                                                                     \
+        COND_CODE_1(                                                                               \
+            DT_NODE_HAS_COMPAT(node, zmk_input_processor_scaler), (FUSED_SCALER(node, n, idx)),    \
+            (COND_CODE_1(                                                                          \
+                DT_NODE_HAS_COMPAT(node, zmk_input_processor_transform),                           \
+                (FUSED_TRANSFORM(node, n, idx)),                                                   \
+                (COND_CODE_1(DT_NODE_HAS_COMPAT(node, zmk_input_processor_code_mapper),            \
+                             (FUSED_CODE_MAPPER(node, n, idx)), (FUSED_DEVICE(node, n, idx)))))))  \
+    }
+
+#define FUSED_STEP(idx, n) FUSED_STEP_FOR(DT_PHANDLE_BY_IDX(n, input_processors, idx), n, idx)
+
+#define SCOPED_PROCESSOR(scope, n, id)                                                             \
+    PROCESSOR_REMAINDERS(scope, n, id)                                                             \
+    static int _CONCAT(fused_processors_##id, scope)(                                              \
+        uint8_t listener_index, struct input_listener_processor_data *processor_data,              \
+        struct input_event *evt) {                                                                 \
+        size_t remainder_index = 0;                                                                \
+        ARG_UNUSED(listener_index);                                                                \
+        ARG_UNUSED(processor_data);                                                                \
+        ARG_UNUSED(remainder_index);                                                               \
+        COND_CODE_1(DT_NODE_HAS_PROP(n, input_processors),                                         \
+                    (LISTIFY(DT_PROP_LEN(n, input_processors), FUSED_STEP, (), n)), ())            \
+        return ZMK_INPUT_PROC_CONTINUE;                                                            \
+    }
+
+#define IL_EXTRACT_CONFIG(n, id, scope)                                                            \
+    {                                                                                              \
+        .fused = _CONCAT(fused_processors_##id, scope),                                            \
+    }
+
+#else
+
+#define SCOPED_PROCESSOR(scope, n, id)                                                             \
+    PROCESSOR_REMAINDERS(scope, n, id)                                                             \
     static const struct zmk_input_processor_entry _CONCAT(                                         \
         processor_##id, scope)[DT_PROP_LEN_OR(n, input_processors, 0)] =                           \
         COND_CODE_1(DT_NODE_HAS_PROP(n, input_processors),                                         \
@@ -360,6 +475,8 @@ static void input_handler(const struct input_listener_config *config,
         .processors = _CONCAT(processor_##id, scope),                                              \
     }
 
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_LISTENER_FUSED_PROCESSORS)
+
 #define IL_EXTRACT_DATA(n, id, scope)                                                              \
     {COND_CODE_1(DT_NODE_HAS_PROP(n, input_processors),                                            \
                  (.remainders_len = PROCESSOR_REM_TRACKERS(n),                                     \
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define DT_DRV_COMPAT zmk_input_processor_acceleration
+
+#include <stdlib.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <drivers/input_processor.h>
+#include <zmk/pointing/input_processor_ops.h>
+
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
+
+#define VELOCITY_SLOTS CONFIG_ZMK_INPUT_PROCESSOR_ACCELERATION_VELOCITY_SLOTS
+
+// Gains in the curve are in thousandths, so 1000 leaves values unchanged.
+#define GAIN_ONE 1000
+
+struct accel_config {
+    uint8_t type;
+    uint16_t slot_ms;
+    size_t codes_len;
+    const uint16_t *codes;
+    // Pairs of speeds in counts per second, in increasing order, and the gains to apply at them.
+    size_t curve_len;
+    const uint32_t *curve;
+};
+
+// Movement over the last VELOCITY_SLOTS * slot_ms milliseconds, in slots of slot_ms each.
+struct accel_data {
+    uint32_t slots[VELOCITY_SLOTS];
+    uint32_t total;
+    int64_t slot_time;
+};
+
+static void advance_slots(const struct accel_config *cfg, struct accel_data *data, int64_t now) {
+    const int64_t slot_time = now / cfg->slot_ms;
+    const int64_t elapsed = slot_time - data->slot_time;
+
+    if (elapsed <= 0) {
+        return;
+    }
+
+    if (elapsed >= VELOCITY_SLOTS) {
+        memset(data->slots, 0, sizeof(data->slots));
+        data->total = 0;
+    } else {
+        for (int64_t t = data->slot_time + 1; t <= slot_time; t++) {
+            uint32_t *slot = &data->slots[t % VELOCITY_SLOTS];
+
+            data->total -= *slot;
+            *slot = 0;
+        }
+    }
+
+    data->slot_time = slot_time;
+}
+
+static uint32_t velocity(const struct accel_config *cfg, const struct accel_data *data) {
+    return (uint64_t)data->total * MSEC_PER_SEC / (cfg->slot_ms * VELOCITY_SLOTS);
+}
+
+// Interpolates the gain for @p speed between the nearest points of the curve.
+static int32_t curve_gain(const struct accel_config *cfg, uint32_t speed) {
+    const uint32_t *point = cfg->curve;
+    const uint32_t *last = cfg->curve + cfg->curve_len - 2;
+
+    if (speed <= point[0]) {
+        return point[1];
+    }
+
+    for (; point < last; point += 2) {
+        const uint32_t *next = point + 2;
+
+        if (speed < next[0]) {
+            const int64_t gain_delta = (int64_t)next[1] - point[1];
+
+            return point[1] + gain_delta * (speed - point[0]) / (next[0] - point[0]);
+        }
+    }
+
+    return last[1];
+}
+
+static int accel_handle_event(const struct device *dev, struct input_event *event, uint32_t param1,
+                              uint32_t param2, struct zmk_input_processor_state *state) {
+    const struct accel_config *cfg = dev->config;
+    struct accel_data *data = dev->data;
+
+    if (event->type != cfg->type ||
+        zmk_input_processor_code_idx(event->code, cfg->codes, cfg->codes_len) < 0) {
+        return ZMK_INPUT_PROC_CONTINUE;
+    }
+
+    advance_slots(cfg, data, k_uptime_get());
+
+    const uint32_t magnitude = abs(event->value);
+
+    data->slots[data->slot_time % VELOCITY_SLOTS] += magnitude;
+    data->total += magnitude;
+
+    const uint32_t current_speed = velocity(cfg, data);
+    const int32_t gain = curve_gain(cfg, current_speed);
+    const int32_t value = event->value;
+
+    zmk_input_processor_scale(event, gain, GAIN_ONE, state ? state->remainder : NULL);
+
+    LOG_DBG("accelerated %d at %u counts/s with gain %d to %d", value, current_speed, gain,
+            event->value);
+
+    return ZMK_INPUT_PROC_CONTINUE;
+}
+
+static int accel_init(const struct device *dev) {
+    const struct accel_config *cfg = dev->config;
+
+    for (size_t i = 2; i < cfg->curve_len; i += 2) {
+        if (cfg->curve[i] <= cfg->curve[i - 2]) {
+            LOG_ERR("Acceleration curve speeds must be in increasing order");
+            return -EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+static struct zmk_input_processor_driver_api accel_driver_api = {
+    .handle_event = accel_handle_event,
+};
+
+#define ACCEL_INST(n)                                                                              \
+    static const uint16_t accel_codes_##n[] = DT_INST_PROP(n, codes);                              \
+    static const uint32_t accel_curve_##n[] = DT_INST_PROP(n, curve);                              \
+    BUILD_ASSERT(ARRAY_SIZE(accel_curve_##n) >= 2 && ARRAY_SIZE(accel_curve_##n) % 2 == 0,         \
+                 "Acceleration curve must be a list of speed and gain pairs");                     \
+    static const struct accel_config accel_config_##n = {                                          \
+        .type = DT_INST_PROP_OR(n, type, INPUT_EV_REL),                                            \
+        .slot_ms = MAX(DT_INST_PROP(n, velocity_window_ms) / VELOCITY_SLOTS, 1),                   \
+        .codes_len = ARRAY_SIZE(accel_codes_##n),                                                  \
+        .codes = accel_codes_##n,                                                                  \
+        .curve_len = ARRAY_SIZE(accel_curve_##n),                                                  \
+        .curve = accel_curve_##n,                                                                  \
+    };                                                                                             \
+    static struct accel_data accel_data_##n;                                                       \
+    DEVICE_DT_INST_DEFINE(n, &accel_init, NULL, &accel_data_##n, &accel_config_##n, POST_KERNEL,   \
+                          CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &accel_driver_api);
+
+DT_INST_FOREACH_STATUS_OKAY(ACCEL_INST)
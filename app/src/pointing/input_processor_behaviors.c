@@ -19,6 +19,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/keymap.h>
 #include <zmk/behavior.h>
 #include <zmk/virtual_key_position.h>
+#include <zmk/workqueue.h>
 
 struct ip_behaviors_config {
     uint8_t index;
@@ -29,6 +30,32 @@ struct ip_behaviors_config {
     const struct zmk_behavior_binding *bindings;
 };
 
+struct ip_behaviors_invocation {
+    const struct zmk_behavior_binding *binding;
+    struct zmk_behavior_binding_event event;
+    bool pressed;
+};
+
+K_MSGQ_DEFINE(ip_behaviors_invocation_msgq, sizeof(struct ip_behaviors_invocation),
+              CONFIG_ZMK_INPUT_PROCESSOR_BEHAVIORS_MAX_EVENTS, 4);
+
+// Input events are processed on the input thread, but behaviors may only be invoked from the input
+// work queue, where the keymap and behavior state they touch is owned.
+static void invoke_work_cb(struct k_work *work) {
+    struct ip_behaviors_invocation invocation;
+
+    while (k_msgq_get(&ip_behaviors_invocation_msgq, &invocation, K_NO_WAIT) >= 0) {
+        int ret = zmk_behavior_invoke_binding(invocation.binding, invocation.event,
+                                              invocation.pressed);
+        if (ret < 0) {
+            LOG_ERR("Failed to invoke %s for position %d (%d)", invocation.binding->behavior_dev,
+                    invocation.event.position, ret);
+        }
+    }
+}
+
+static K_WORK_DEFINE(invoke_work, invoke_work_cb);
+
 static int ip_behaviors_handle_event(const struct device *dev, struct input_event *event,
                                      uint32_t param1, uint32_t param2,
                                      struct zmk_input_processor_state *state) {
@@ -52,11 +79,21 @@ static int ip_behaviors_handle_event(const struct device *dev, struct input_even
             LOG_DBG("FOUND A MATCHING CODE, invoke %s for position %d with %d listeners",
                     cfg->bindings[i].behavior_dev, behavior_event.position,
                     ZMK_INPUT_LISTENERS_LEN);
-            int ret = zmk_behavior_invoke_binding(&cfg->bindings[i], behavior_event, event->value);
+            struct ip_behaviors_invocation invocation = {
+                .binding = &cfg->bindings[i],
+                .event = behavior_event,
+                .pressed = event->value,
+            };
+
+            int ret = k_msgq_put(&ip_behaviors_invocation_msgq, &invocation, K_MSEC(10));
             if (ret < 0) {
+                LOG_ERR("Failed to queue invocation of %s (%d)", cfg->bindings[i].behavior_dev,
+                        ret);
                 return ret;
             }
 
+            k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &invoke_work);
+
             return ZMK_INPUT_PROC_STOP;
         }
     }
@@ -9,6 +9,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <drivers/input_processor.h>
+#include <zmk/pointing/input_processor_ops.h>
 
 #include <zephyr/logging/log.h>
 
@@ -28,13 +29,9 @@ static int cm_handle_event(const struct device *dev, struct input_event *event,
         return ZMK_INPUT_PROC_CONTINUE;
     }
 
-    for (int i = 0; i < cfg->mapping_size / 2; i++) {
-        if (cfg->mapping[i * 2] == event->code) {
-            uint16_t orig = event->code;
-            event->code = cfg->mapping[(i * 2) + 1];
-            LOG_DBG("Remapped %d to %d", orig, event->code);
-            break;
-        }
+    uint16_t orig = event->code;
+    if (zmk_input_processor_map_code(event, cfg->mapping, cfg->mapping_size)) {
+        LOG_DBG("Remapped %d to %d", orig, event->code);
     }
 
     return ZMK_INPUT_PROC_CONTINUE;
@@ -9,6 +9,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <drivers/input_processor.h>
+#include <zmk/pointing/input_processor_ops.h>
 
 #include <zephyr/logging/log.h>
 
@@ -22,22 +23,13 @@ struct scaler_config {
 
 static int scale_val(struct input_event *event, uint32_t mul, uint32_t div,
                      struct zmk_input_processor_state *state) {
-    int16_t value_mul = event->value * (int16_t)mul;
+    int16_t *remainder = state ? state->remainder : NULL;
+    int32_t value = event->value;
 
-    if (state && state->remainder) {
-        value_mul += *state->remainder;
-    }
-
-    int16_t scaled = value_mul / (int16_t)div;
-
-    if (state && state->remainder) {
-        *state->remainder = value_mul - (scaled * (int16_t)div);
-    }
-
-    LOG_DBG("scaled %d with %d/%d to %d with remainder %d", event->value, mul, div, scaled,
-            (state && state->remainder) ? *state->remainder : 0);
+    zmk_input_processor_scale(event, mul, div, remainder);
 
-    event->value = scaled;
+    LOG_DBG("scaled %d with %d/%d to %d with remainder %d", value, mul, div, event->value,
+            remainder ? *remainder : 0);
 
     return 0;
 }
@@ -50,10 +42,8 @@ static int scaler_handle_event(const struct device *dev, struct input_event *eve
         return ZMK_INPUT_PROC_CONTINUE;
     }
 
-    for (int i = 0; i < cfg->codes_len; i++) {
-        if (cfg->codes[i] == event->code) {
-            return scale_val(event, param1, param2, state);
-        }
+    if (zmk_input_processor_code_idx(event->code, cfg->codes, cfg->codes_len) >= 0) {
+        return scale_val(event, param1, param2, state);
     }
 
     return ZMK_INPUT_PROC_CONTINUE;
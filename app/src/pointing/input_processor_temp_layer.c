@@ -15,6 +15,8 @@
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/keycode_state_changed.h>
 #include <zmk/events/layer_state_changed.h>
+#include <zmk/timer_wheel.h>
+#include <zmk/workqueue.h>
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -39,8 +41,10 @@ struct temp_layer_data {
     struct temp_layer_state state;
 };
 
-/* Static Work Queue Items */
-static struct k_work_delayable layer_disable_works[MAX_LAYERS];
+/* Layer Disable Timers */
+static struct zmk_timer layer_disable_timers[MAX_LAYERS];
+// Deadlines set from the input thread, for layer_action_work to start the timers with.
+static int64_t layer_disable_at[MAX_LAYERS];
 
 /* Position Search */
 static bool position_is_excluded(const struct temp_layer_config *config, uint32_t position) {
@@ -101,7 +105,7 @@ static void layer_action_work_cb(struct k_work *work) {
 
     struct layer_state_action action;
 
-    while (k_msgq_get(&temp_layer_action_msgq, &action, K_MSEC(10)) >= 0) {
+    while (k_msgq_get(&temp_layer_action_msgq, &action, K_NO_WAIT) >= 0) {
         if (!action.activate) {
             if (zmk_keymap_layer_active(action.layer)) {
                 update_layer_state(&data->state, false);
@@ -111,20 +115,36 @@ static void layer_action_work_cb(struct k_work *work) {
         }
     }
 
+    for (int i = 0; i < MAX_LAYERS; i++) {
+        if (layer_disable_at[i] != 0) {
+            zmk_timer_start(&layer_disable_timers[i], layer_disable_at[i]);
+            layer_disable_at[i] = 0;
+        }
+    }
+
     k_mutex_unlock(&data->lock);
 }
 
 static K_WORK_DEFINE(layer_action_work, layer_action_work_cb);
 
-/* Work Queue Callback */
-static void layer_disable_callback(struct k_work *work) {
-    struct k_work_delayable *d_work = k_work_delayable_from_work(work);
-    int layer_index = ARRAY_INDEX(layer_disable_works, d_work);
+/* Timer Callback */
+static void layer_disable_callback(struct zmk_timer *timer) {
+    const struct device *dev = DEVICE_DT_INST_GET(0);
+    struct temp_layer_data *data = (struct temp_layer_data *)dev->data;
+    int layer_index = ARRAY_INDEX(layer_disable_timers, timer);
+
+    int ret = k_mutex_lock(&data->lock, K_FOREVER);
+    if (ret < 0) {
+        LOG_ERR("Error locking for updating %d", ret);
+        return;
+    }
 
-    struct layer_state_action action = {.layer = layer_index, .activate = false};
+    // Input since the timer was started has already pushed the deadline back.
+    if (layer_disable_at[layer_index] == 0 && zmk_keymap_layer_active(layer_index)) {
+        update_layer_state(&data->state, false);
+    }
 
-    int ret = k_msgq_put(&temp_layer_action_msgq, &action, K_MSEC(10));
-    k_work_submit(&layer_action_work);
+    k_mutex_unlock(&data->lock);
 }
 
 /* Event Handlers */
@@ -137,7 +157,8 @@ static int handle_layer_state_changed(const struct device *dev, const zmk_event_
     if (!zmk_keymap_layer_active(zmk_keymap_layer_index_to_id(data->state.toggle_layer))) {
         LOG_DBG("Deactivating layer that was activated by this processor");
         data->state.is_active = false;
-        k_work_cancel_delayable(&layer_disable_works[data->state.toggle_layer]);
+        layer_disable_at[data->state.toggle_layer] = 0;
+        zmk_timer_stop(&layer_disable_timers[data->state.toggle_layer]);
     }
     ret = k_mutex_unlock(&data->lock);
     if (ret < 0) {
@@ -255,12 +276,15 @@ static int temp_layer_handle_event(const struct device *dev, struct input_event
         if (ret < 0) {
             LOG_ERR("Failed to enqueue action to enable layer %d (%d)", param1, ret);
         } else {
-            k_work_submit(&layer_action_work);
+            k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &layer_action_work);
         }
     }
 
     if (param2 > 0) {
-        k_work_reschedule(&layer_disable_works[param1], K_MSEC(param2));
+        // Timers can only be started from the input work queue, so this is handed over to
+        // layer_action_work. That is a no-op while it is already pending during fast movement.
+        layer_disable_at[param1] = k_uptime_get() + param2;
+        k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &layer_action_work);
     }
 
     k_mutex_unlock(&data->lock);
@@ -273,7 +297,7 @@ static int temp_layer_init(const struct device *dev) {
     k_mutex_init(&data->lock);
 
     for (int i = 0; i < MAX_LAYERS; i++) {
-        k_work_init_delayable(&layer_disable_works[i], layer_disable_callback);
+        zmk_timer_init(&layer_disable_timers[i], layer_disable_callback);
     }
 
     return 0;
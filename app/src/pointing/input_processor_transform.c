@@ -9,8 +9,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <drivers/input_processor.h>
-
-#include <dt-bindings/zmk/input_transform.h>
+#include <zmk/pointing/input_processor_ops.h>
 
 #include <zephyr/logging/log.h>
 
@@ -27,16 +26,6 @@ struct ipt_config {
     const uint16_t *y_codes;
 };
 
-static int code_idx(uint16_t code, const uint16_t *list, size_t len) {
-    for (int i = 0; i < len; i++) {
-        if (list[i] == code) {
-            return i;
-        }
-    }
-
-    return -ENODEV;
-}
-
 static int ipt_handle_event(const struct device *dev, struct input_event *event, uint32_t param1,
                             uint32_t param2, struct zmk_input_processor_state *state) {
     const struct ipt_config *cfg = dev->config;
@@ -45,25 +34,8 @@ static int ipt_handle_event(const struct device *dev, struct input_event *event,
         return ZMK_INPUT_PROC_CONTINUE;
     }
 
-    if (param1 & INPUT_TRANSFORM_XY_SWAP) {
-        int idx = code_idx(event->code, cfg->x_codes, cfg->x_codes_size);
-        if (idx >= 0) {
-            event->code = cfg->y_codes[idx];
-        } else {
-            idx = code_idx(event->code, cfg->y_codes, cfg->y_codes_size);
-
-            if (idx >= 0) {
-                event->code = cfg->x_codes[idx];
-            }
-        }
-    }
-
-    if ((param1 & INPUT_TRANSFORM_X_INVERT &&
-         code_idx(event->code, cfg->x_codes, cfg->x_codes_size) >= 0) ||
-        (param1 & INPUT_TRANSFORM_Y_INVERT &&
-         code_idx(event->code, cfg->y_codes, cfg->y_codes_size) >= 0)) {
-        event->value = -event->value;
-    }
+    zmk_input_processor_transform(event, param1, cfg->x_codes, cfg->x_codes_size, cfg->y_codes,
+                                  cfg->y_codes_size);
 
     return ZMK_INPUT_PROC_CONTINUE;
 }
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#if IS_ENABLED(CONFIG_SHELL)
+#include <zephyr/shell/shell.h>
+#endif
+
+#include <zmk/endpoints.h>
+#include <zmk/hid.h>
+#include <zmk/pointing/report_accumulator.h>
+#include <zmk/workqueue.h>
+
+// Changes which haven't been sent to the endpoint yet. Movement and scrolling are summed in wider
+// types than the report's fields, so nothing is lost if they overflow a single report.
+static struct zmk_pointing_report_delta pending;
+static bool has_pending;
+static struct zmk_pointing_report_stats stats;
+
+// Protects the pending changes, the stats and the HID mouse report, which is shared between the
+// input thread and flush_work.
+static K_MUTEX_DEFINE(lock);
+
+static void flush_work_cb(struct k_work *work);
+
+static K_WORK_DEFINE(flush_work, flush_work_cb);
+
+// Takes as much of @p value as fits in a report field, leaving the rest for the next report.
+static int16_t take_field(int32_t *value) {
+    const int16_t taken = CLAMP(*value, INT16_MIN, INT16_MAX);
+
+    *value -= taken;
+    return taken;
+}
+
+static void send_pending(void) {
+    if (pending.scroll) {
+        const int16_t x = take_field(&pending.scroll_x);
+        zmk_hid_mouse_scroll_set(x, take_field(&pending.scroll_y));
+    }
+
+    if (pending.movement) {
+        const int16_t x = take_field(&pending.x);
+        zmk_hid_mouse_movement_set(x, take_field(&pending.y));
+    }
+
+    for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
+        if ((pending.button_set & BIT(i)) != 0) {
+            zmk_hid_mouse_button_press(i);
+        }
+    }
+
+    for (int i = 0; i < ZMK_HID_MOUSE_NUM_BUTTONS; i++) {
+        if ((pending.button_clear & BIT(i)) != 0) {
+            zmk_hid_mouse_button_release(i);
+        }
+    }
+
+    if (zmk_endpoint_send_mouse_report() == 0) {
+        stats.sent++;
+    } else {
+        stats.dropped++;
+    }
+
+    zmk_hid_mouse_scroll_set(0, 0);
+    zmk_hid_mouse_movement_set(0, 0);
+
+    pending.button_set = pending.button_clear = 0;
+    pending.scroll = pending.scroll_x != 0 || pending.scroll_y != 0;
+    pending.movement = pending.x != 0 || pending.y != 0;
+    has_pending = pending.scroll || pending.movement;
+}
+
+static int32_t add_saturating(int32_t a, int32_t b) {
+    int32_t sum;
+
+    if (__builtin_add_overflow(a, b, &sum)) {
+        return b < 0 ? INT32_MIN : INT32_MAX;
+    }
+
+    return sum;
+}
+
+void zmk_pointing_report_accumulate(const struct zmk_pointing_report_delta *delta) {
+    k_mutex_lock(&lock, K_FOREVER);
+
+    stats.generated++;
+
+    // Folding a button change into the opposite change the host hasn't seen yet would lose both,
+    // so send the earlier one first even if the endpoint is busy.
+    if (has_pending && ((pending.button_set & delta->button_clear) != 0 ||
+                        (pending.button_clear & delta->button_set) != 0)) {
+        send_pending();
+    }
+
+    if (has_pending) {
+        stats.coalesced++;
+    }
+
+    pending.movement |= delta->movement;
+    pending.scroll |= delta->scroll;
+    pending.x = add_saturating(pending.x, delta->x);
+    pending.y = add_saturating(pending.y, delta->y);
+    pending.scroll_x = add_saturating(pending.scroll_x, delta->scroll_x);
+    pending.scroll_y = add_saturating(pending.scroll_y, delta->scroll_y);
+    pending.button_set = (pending.button_set & ~delta->button_clear) | delta->button_set;
+    pending.button_clear = (pending.button_clear & ~delta->button_set) | delta->button_clear;
+    has_pending = true;
+
+    if (!zmk_endpoint_mouse_report_waiting()) {
+        send_pending();
+    }
+
+    k_mutex_unlock(&lock);
+}
+
+static void flush_work_cb(struct k_work *work) {
+    k_mutex_lock(&lock, K_FOREVER);
+
+    if (has_pending && !zmk_endpoint_mouse_report_waiting()) {
+        send_pending();
+    }
+
+    k_mutex_unlock(&lock);
+}
+
+void zmk_pointing_report_tx_ready(void) {
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &flush_work);
+}
+
+void zmk_pointing_report_get_stats(struct zmk_pointing_report_stats *out) {
+    k_mutex_lock(&lock, K_FOREVER);
+    *out = stats;
+    k_mutex_unlock(&lock);
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static int cmd_pointer_reports_show(const struct shell *sh, size_t argc, char **argv) {
+    struct zmk_pointing_report_stats current;
+
+    zmk_pointing_report_get_stats(&current);
+
+    shell_print(sh, "generated: %u", current.generated);
+    shell_print(sh, "sent:      %u", current.sent);
+    shell_print(sh, "coalesced: %u", current.coalesced);
+    shell_print(sh, "dropped:   %u", current.dropped);
+
+    return 0;
+}
+
+static int cmd_pointer_reports_reset(const struct shell *sh, size_t argc, char **argv) {
+    k_mutex_lock(&lock, K_FOREVER);
+    stats = (struct zmk_pointing_report_stats){0};
+    k_mutex_unlock(&lock);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_pointer_reports,
+                               SHELL_CMD(show, NULL, "Show mouse report counts",
+                                         cmd_pointer_reports_show),
+                               SHELL_CMD(reset, NULL, "Clear the mouse report counts",
+                                         cmd_pointer_reports_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(pointer_reports, &sub_pointer_reports, "Mouse report accumulator statistics",
+                   NULL);
+
+#endif // IS_ENABLED(CONFIG_SHELL)
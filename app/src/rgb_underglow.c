@@ -204,7 +204,8 @@ static void zmk_rgb_underglow_tick_handler(struct k_timer *timer) {
         return;
     }
 
-    k_work_submit_to_queue(zmk_workqueue_lowprio_work_q(), &underglow_tick_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(RGB_UNDERGLOW)),
+                           &underglow_tick_work);
 }
 
 K_TIMER_DEFINE(underglow_tick, zmk_rgb_underglow_tick_handler, NULL);
@@ -282,7 +283,9 @@ static int zmk_rgb_underglow_init(void) {
 
 int zmk_rgb_underglow_save_state(void) {
 #if IS_ENABLED(CONFIG_SETTINGS)
-    int ret = k_work_reschedule(&underglow_save_work, K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+    int ret = k_work_reschedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(SETTINGS_SAVE)),
+                                          &underglow_save_work,
+                                          K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
     return MIN(ret, 0);
 #else
     return 0;
@@ -340,7 +343,8 @@ int zmk_rgb_underglow_off(void) {
     }
 #endif
 
-    k_work_submit_to_queue(zmk_workqueue_lowprio_work_q(), &underglow_off_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_FOR(RGB_UNDERGLOW)),
+                           &underglow_off_work);
 
     k_timer_stop(&underglow_tick);
     state.on = false;
@@ -24,6 +24,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/behavior.h>
 #include <zmk/sensors.h>
 #include <zmk/split/transport/central.h>
+#include <zmk/split/central.h>
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
 #include <zmk/event_manager.h>
@@ -33,10 +34,21 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/pointing/input_split.h>
 #include <zmk/hid_indicators_types.h>
 #include <zmk/physical_layouts.h>
+#include <zmk/matrix.h>
+#include <zmk/workqueue.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+#include <zmk/varint.h>
+#endif
 
 static int start_scanning(void);
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+// Position deltas aren't limited to the 128 positions of the legacy position state bitmap.
+#define POSITION_STATE_DATA_LEN MAX(16, DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8))
+#else
 #define POSITION_STATE_DATA_LEN 16
+#endif
 
 enum peripheral_slot_state {
     PERIPHERAL_SLOT_STATE_OPEN,
@@ -62,6 +74,25 @@ struct peripheral_slot {
     uint16_t selected_physical_layout_handle;
     uint8_t position_state[POSITION_STATE_DATA_LEN];
     uint8_t changed_positions[POSITION_STATE_DATA_LEN];
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+    bool position_deltas_synced;
+    bool position_snapshot_pending;
+    // Sequence number of the next position deltas notification we expect.
+    uint8_t position_deltas_seq;
+    int64_t last_position_timestamp;
+    struct bt_gatt_read_params position_snapshot_read_params;
+    uint8_t position_snapshot[1 + POSITION_STATE_DATA_LEN];
+    uint16_t position_snapshot_len;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    struct bt_gatt_subscribe_params clock_sync_subscribe_params;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    uint16_t run_behaviors_handle;
+    uint16_t behavior_ids_handle;
+    bool behavior_ids_read_pending;
+    struct bt_gatt_read_params behavior_ids_read_params;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
 };
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -150,6 +181,21 @@ void peripheral_event_work_callback(struct k_work *work);
 
 K_WORK_DEFINE(peripheral_event_work, peripheral_event_work_callback);
 
+static void queue_key_position_event(uint8_t source, uint32_t position, bool pressed,
+                                     int64_t timestamp) {
+    struct peripheral_event_wrapper ev = {
+        .source = source,
+        .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
+                  .data = {.key_position_event = {
+                               .position = position,
+                               .pressed = pressed,
+                               .timestamp = timestamp,
+                           }}}};
+
+    k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
+}
+
 int peripheral_slot_index_for_conn(struct bt_conn *conn) {
     for (int i = 0; i < ZMK_SPLIT_BLE_PERIPHERAL_COUNT; i++) {
         if (peripherals[i].conn == conn) {
@@ -192,17 +238,7 @@ int release_peripheral_slot(int index) {
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
         for (int j = 0; j < 8; j++) {
             if (slot->position_state[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                struct peripheral_event_wrapper ev = {
-                    .source = index,
-                    .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
-                              .data = {.key_position_event = {
-                                           .position = position,
-                                           .pressed = false,
-                                       }}}};
-
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
+                queue_key_position_event(index, (i * 8) + j, false, k_uptime_get());
             }
         }
     }
@@ -212,8 +248,21 @@ int release_peripheral_slot(int index) {
         slot->changed_positions[i] = 0U;
     }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+    slot->position_deltas_synced = false;
+    slot->position_snapshot_pending = false;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
     // Clean up previously discovered handles;
     slot->subscribe_params.value_handle = 0;
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    slot->clock_sync_subscribe_params.value_handle = 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    slot->run_behaviors_handle = 0;
+    slot->behavior_ids_handle = 0;
+    slot->behavior_ids_read_pending = false;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
     slot->run_behavior_handle = 0;
     slot->selected_physical_layout_handle = 0;
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
@@ -295,7 +344,7 @@ static uint8_t split_central_sensor_notify_func(struct bt_conn *conn,
                            }}}};
 
     k_msgq_put(&peripheral_event_msgq, &event_wrapper, K_NO_WAIT);
-    k_work_submit(&peripheral_event_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
 
     return BT_GATT_ITER_CONTINUE;
 }
@@ -336,7 +385,7 @@ static uint8_t peripheral_input_event_notify_cb(struct bt_conn *conn,
                                    }}}};
 
             k_msgq_put(&peripheral_event_msgq, &event_wrapper, K_NO_WAIT);
-            k_work_submit(&peripheral_event_work);
+            k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
             break;
         }
     }
@@ -365,25 +414,19 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
     LOG_DBG("[NOTIFICATION] data %p length %u", data, length);
 
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
-        slot->changed_positions[i] = ((uint8_t *)data)[i] ^ slot->position_state[i];
-        slot->position_state[i] = ((uint8_t *)data)[i];
+        uint8_t state = i < length ? ((uint8_t *)data)[i] : 0;
+        slot->changed_positions[i] = state ^ slot->position_state[i];
+        slot->position_state[i] = state;
     }
     LOG_HEXDUMP_DBG(slot->position_state, POSITION_STATE_DATA_LEN, "data");
 
+    int64_t timestamp = k_uptime_get();
+
     for (int i = 0; i < POSITION_STATE_DATA_LEN; i++) {
         for (int j = 0; j < 8; j++) {
             if (slot->changed_positions[i] & BIT(j)) {
-                uint32_t position = (i * 8) + j;
-                bool pressed = slot->position_state[i] & BIT(j);
-                struct peripheral_event_wrapper ev = {
-                    .source = peripheral_slot_index_for_conn(conn),
-                    .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT,
-                              .data = {.key_position_event = {
-                                           .position = position,
-                                           .pressed = pressed,
-                                       }}}};
-                k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-                k_work_submit(&peripheral_event_work);
+                queue_key_position_event(peripheral_slot_index_for_conn(conn), (i * 8) + j,
+                                         slot->position_state[i] & BIT(j), timestamp);
             }
         }
     }
@@ -391,6 +434,264 @@ static uint8_t split_central_notify_func(struct bt_conn *conn,
     return BT_GATT_ITER_CONTINUE;
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
+/**
+ * Updates our copy of a peripheral's position state, raising an event if it changed.
+ */
+static void update_peripheral_position(struct peripheral_slot *slot, uint32_t position,
+                                       bool pressed, int64_t timestamp) {
+    if (position >= POSITION_STATE_DATA_LEN * 8) {
+        LOG_WRN("Ignoring out of range position %d", position);
+        return;
+    }
+
+    if (!!(slot->position_state[position / 8] & BIT(position % 8)) == pressed) {
+        return;
+    }
+
+    WRITE_BIT(slot->position_state[position / 8], position % 8, pressed);
+
+    // Events are raised in the order they arrive, so keep their timestamps in that order too.
+    timestamp = MAX(timestamp, slot->last_position_timestamp);
+    slot->last_position_timestamp = timestamp;
+
+    queue_key_position_event(slot - peripherals, position, pressed, timestamp);
+}
+
+static uint8_t split_central_position_snapshot_read_func(struct bt_conn *conn, uint8_t err,
+                                                         struct bt_gatt_read_params *params,
+                                                         const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (err > 0) {
+        LOG_ERR("Error reading peripheral position state snapshot: %u", err);
+        slot->position_snapshot_pending = false;
+        return BT_GATT_ITER_STOP;
+    }
+
+    if (data) {
+        // Long reads arrive in pieces.
+        uint16_t copy_len =
+            MIN(length, sizeof(slot->position_snapshot) - slot->position_snapshot_len);
+        memcpy(slot->position_snapshot + slot->position_snapshot_len, data, copy_len);
+        slot->position_snapshot_len += copy_len;
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    slot->position_snapshot_pending = false;
+
+    if (slot->position_snapshot_len < 1) {
+        LOG_WRN("Empty position state snapshot");
+        return BT_GATT_ITER_STOP;
+    }
+
+    const uint8_t *state = &slot->position_snapshot[1];
+    size_t state_len = slot->position_snapshot_len - 1;
+    int64_t timestamp = k_uptime_get();
+
+    for (uint32_t position = 0; position < POSITION_STATE_DATA_LEN * 8; position++) {
+        bool pressed = (position / 8) < state_len && (state[position / 8] & BIT(position % 8));
+        update_peripheral_position(slot, position, pressed, timestamp);
+    }
+
+    slot->position_deltas_seq = slot->position_snapshot[0] + 1;
+    slot->position_deltas_synced = true;
+
+    LOG_DBG("Resynced peripheral positions at sequence %d", slot->position_snapshot[0]);
+
+    return BT_GATT_ITER_STOP;
+}
+
+static void request_position_snapshot(struct bt_conn *conn, struct peripheral_slot *slot) {
+    slot->position_deltas_synced = false;
+
+    if (slot->position_snapshot_pending) {
+        return;
+    }
+
+    slot->position_snapshot_len = 0;
+    slot->position_snapshot_read_params = (struct bt_gatt_read_params){
+        .func = split_central_position_snapshot_read_func,
+        .handle_count = 1,
+        .single = {.handle = slot->subscribe_params.value_handle, .offset = 0},
+    };
+
+    int err = bt_gatt_read(conn, &slot->position_snapshot_read_params);
+    if (err < 0) {
+        LOG_ERR("Failed to read peripheral position state snapshot (err %d)", err);
+        return;
+    }
+
+    slot->position_snapshot_pending = true;
+}
+
+static uint8_t split_central_position_deltas_notify_func(struct bt_conn *conn,
+                                                         struct bt_gatt_subscribe_params *params,
+                                                         const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (slot == NULL) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    LOG_HEXDUMP_DBG(data, length, "Position deltas");
+
+    if (length < ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN) {
+        LOG_WRN("Ignoring position deltas notify with a short header");
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    const uint8_t *buf = data;
+    uint8_t seq = buf[0];
+
+    if (!slot->position_deltas_synced) {
+        // Anything sent before the snapshot we're waiting on is already part of it, and anything
+        // sent after will arrive after it.
+        request_position_snapshot(conn, slot);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    if (seq != slot->position_deltas_seq) {
+        if ((int8_t)(seq - slot->position_deltas_seq) < 0) {
+            LOG_DBG("Ignoring position deltas %d already covered by a snapshot", seq);
+            return BT_GATT_ITER_CONTINUE;
+        }
+
+        LOG_WRN("Missed position deltas (expected %d, got %d), resyncing",
+                slot->position_deltas_seq, seq);
+        request_position_snapshot(conn, slot);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    slot->position_deltas_seq = seq + 1;
+
+    // Without a synced clock, assume the notification was built as it arrived.
+    int64_t built_at = k_uptime_get();
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    zmk_split_central_peripheral_time_to_local(slot - peripherals, sys_get_le32(&buf[1]),
+                                               &built_at);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+    for (size_t offset = ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN; offset < length;) {
+        uint32_t key, age;
+        int ret = zmk_varint_decode(buf + offset, length - offset, &key);
+        if (ret > 0) {
+            offset += ret;
+            ret = zmk_varint_decode(buf + offset, length - offset, &age);
+        }
+
+        if (ret < 0) {
+            LOG_WRN("Malformed position deltas, resyncing");
+            request_position_snapshot(conn, slot);
+            break;
+        }
+
+        offset += ret;
+
+        update_peripheral_position(slot, ZMK_SPLIT_POSITION_DELTA_POSITION(key),
+                                   ZMK_SPLIT_POSITION_DELTA_PRESSED(key), built_at - age);
+    }
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+static uint8_t split_central_clock_sync_notify_func(struct bt_conn *conn,
+                                                    struct bt_gatt_subscribe_params *params,
+                                                    const void *data, uint16_t length) {
+    int64_t received_time = k_ticks_to_us_floor64(k_uptime_ticks());
+
+    if (!data) {
+        LOG_DBG("[UNSUBSCRIBED]");
+        params->value_handle = 0U;
+        return BT_GATT_ITER_STOP;
+    }
+
+    struct zmk_split_clock_sync_response response;
+    if (length != sizeof(response)) {
+        LOG_WRN("Ignoring clock sync notify of unexpected length %d", length);
+        return BT_GATT_ITER_CONTINUE;
+    }
+
+    memcpy(&response, data, sizeof(response));
+
+    struct peripheral_event_wrapper ev = {
+        .source = peripheral_slot_index_for_conn(conn),
+        .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT,
+                  .data = {.clock_sync_event = {
+                               .central_time = response.central_time,
+                               .peripheral_time = response.peripheral_time,
+                               .received_time = received_time,
+                           }}}};
+
+    k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
+
+    return BT_GATT_ITER_CONTINUE;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
+static uint8_t split_central_behavior_ids_read_func(struct bt_conn *conn, uint8_t err,
+                                                    struct bt_gatt_read_params *params,
+                                                    const void *data, uint16_t length) {
+    struct peripheral_slot *slot = peripheral_slot_for_conn(conn);
+
+    if (!slot) {
+        LOG_ERR("No peripheral state found for connection");
+        return BT_GATT_ITER_STOP;
+    }
+
+    slot->behavior_ids_read_pending = false;
+
+    if (err > 0) {
+        LOG_ERR("Error reading peripheral behavior IDs: %u", err);
+        return BT_GATT_ITER_STOP;
+    }
+
+    struct zmk_split_behavior_ids ids;
+    if (!data || length != sizeof(ids)) {
+        LOG_WRN("Ignoring behavior IDs read of unexpected length %d", length);
+        return BT_GATT_ITER_STOP;
+    }
+
+    memcpy(&ids, data, sizeof(ids));
+
+    struct peripheral_event_wrapper ev = {
+        .source = peripheral_slot_index_for_conn(conn),
+        .event = {.type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT,
+                  .data = {.behavior_ids_event = {
+                               .crc16_ids = ids.crc16_ids,
+                               .table_hash = sys_le32_to_cpu(ids.table_hash),
+                           }}}};
+
+    k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
+
+    return BT_GATT_ITER_STOP;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
 
 static uint8_t split_central_battery_level_notify_func(struct bt_conn *conn,
@@ -426,7 +727,7 @@ static uint8_t split_central_battery_level_notify_func(struct bt_conn *conn,
                            }}}};
 
     k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&peripheral_event_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
 
     return BT_GATT_ITER_CONTINUE;
 }
@@ -470,7 +771,7 @@ static uint8_t split_central_battery_level_read_func(struct bt_conn *conn, uint8
                            }}}};
 
     k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&peripheral_event_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
 
     return BT_GATT_ITER_CONTINUE;
 }
@@ -568,6 +869,20 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             slot->subscribe_params.notify = split_central_notify_func;
             slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
             split_central_subscribe(conn, &slot->subscribe_params);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+        } else if (bt_uuid_cmp(chrc_uuid,
+                               BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_DELTAS_UUID)) == 0) {
+            LOG_DBG("Found position deltas characteristic");
+            slot->subscribe_params.disc_params = &slot->sub_discover_params;
+            slot->subscribe_params.end_handle = slot->discover_params.end_handle;
+            slot->subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
+            slot->subscribe_params.notify = split_central_position_deltas_notify_func;
+            slot->subscribe_params.value = BT_GATT_CCC_NOTIFY;
+            split_central_subscribe(conn, &slot->subscribe_params);
+
+            // Start from the peripheral's current state, in case keys are already held.
+            request_position_snapshot(conn, slot);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
 #if ZMK_KEYMAP_HAS_SENSORS
         } else if (bt_uuid_cmp(chrc_uuid,
                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_SENSOR_STATE_UUID)) == 0) {
@@ -614,6 +929,27 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
             LOG_DBG("Found select physical layout handle");
             slot->selected_physical_layout_handle = bt_gatt_attr_value_handle(attr);
             k_work_submit(&update_peripherals_selected_layouts_work);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+        } else if (!bt_uuid_cmp(chrc_uuid,
+                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_CLOCK_SYNC_UUID))) {
+            LOG_DBG("Found clock sync characteristic");
+            slot->clock_sync_subscribe_params.disc_params = &slot->sub_discover_params;
+            slot->clock_sync_subscribe_params.end_handle = slot->discover_params.end_handle;
+            slot->clock_sync_subscribe_params.value_handle = bt_gatt_attr_value_handle(attr);
+            slot->clock_sync_subscribe_params.notify = split_central_clock_sync_notify_func;
+            slot->clock_sync_subscribe_params.value = BT_GATT_CCC_NOTIFY;
+            split_central_subscribe(conn, &slot->clock_sync_subscribe_params);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+        } else if (!bt_uuid_cmp(chrc_uuid,
+                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIORS_UUID))) {
+            LOG_DBG("Found run behaviors handle");
+            slot->run_behaviors_handle = bt_gatt_attr_value_handle(attr);
+        } else if (!bt_uuid_cmp(chrc_uuid,
+                                BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_IDS_UUID))) {
+            LOG_DBG("Found behavior IDs handle");
+            slot->behavior_ids_handle = bt_gatt_attr_value_handle(attr);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
         } else if (!bt_uuid_cmp(((struct bt_gatt_chrc *)attr->user_data)->uuid,
                                 BT_UUID_DECLARE_128(ZMK_SPLIT_BT_UPDATE_HID_INDICATORS_UUID))) {
@@ -695,6 +1031,12 @@ static uint8_t split_central_chrc_discovery_func(struct bt_conn *conn,
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
     subscribed = subscribed && slot->update_hid_indicators;
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    subscribed = subscribed && slot->clock_sync_subscribe_params.value_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    subscribed = subscribed && slot->run_behaviors_handle && slot->behavior_ids_handle;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
     subscribed = subscribed && slot->batt_lvl_subscribe_params.value_handle;
 #endif /* IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING) */
@@ -965,7 +1307,7 @@ static void split_central_disconnected(struct bt_conn *conn, uint8_t reason) {
                            }}}};
 
     k_msgq_put(&peripheral_event_msgq, &ev, K_NO_WAIT);
-    k_work_submit(&peripheral_event_work);
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &peripheral_event_work);
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
 
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -1093,6 +1435,68 @@ void split_central_split_run_callback(struct k_work *work) {
             }
             break;
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+        case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK: {
+            struct peripheral_slot *slot = &peripherals[payload_wrapper.source];
+            if (!slot->clock_sync_subscribe_params.value_handle) {
+                // Peripherals built without clock sync don't have the characteristic.
+                break;
+            }
+
+            // The command may have waited in the queue, so take the time just before it's sent.
+            struct zmk_split_clock_sync_request request = {
+                .central_time = k_ticks_to_us_floor64(k_uptime_ticks()),
+            };
+
+            int err = bt_gatt_write_without_response(
+                slot->conn, slot->clock_sync_subscribe_params.value_handle, &request,
+                sizeof(request), false);
+
+            if (err) {
+                LOG_ERR("Failed to write clock sync characteristic (err %d)", err);
+            }
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+        case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS: {
+            struct peripheral_slot *slot = &peripherals[payload_wrapper.source];
+            if (!slot->run_behaviors_handle) {
+                LOG_ERR("Run behaviors handle not found");
+                continue;
+            }
+
+            int err = bt_gatt_write_without_response(
+                slot->conn, slot->run_behaviors_handle,
+                payload_wrapper.cmd.data.invoke_behaviors.buf,
+                payload_wrapper.cmd.data.invoke_behaviors.len, true);
+
+            if (err) {
+                LOG_ERR("Failed to write the behaviors characteristic (err %d)", err);
+            }
+            break;
+        }
+        case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS: {
+            struct peripheral_slot *slot = &peripherals[payload_wrapper.source];
+            if (!slot->behavior_ids_handle || slot->behavior_ids_read_pending) {
+                // Peripherals built without local ID support don't have the characteristic.
+                break;
+            }
+
+            slot->behavior_ids_read_params.func = split_central_behavior_ids_read_func;
+            slot->behavior_ids_read_params.handle_count = 1;
+            slot->behavior_ids_read_params.single.handle = slot->behavior_ids_handle;
+            slot->behavior_ids_read_params.single.offset = 0;
+
+            int err = bt_gatt_read(slot->conn, &slot->behavior_ids_read_params);
+            if (err) {
+                LOG_ERR("Failed to read the behavior IDs characteristic (err %d)", err);
+            } else {
+                slot->behavior_ids_read_pending = true;
+            }
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
         default:
             LOG_WRN("Unsupported wrapped central command type %d", payload_wrapper.cmd.type);
             return;
@@ -1176,10 +1580,37 @@ static int split_central_bt_send_command(uint8_t source,
     switch (cmd.type) {
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_PHYSICAL_LAYOUT:
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS:
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR: {
         struct central_cmd_wrapper wrapper = {.source = source, .cmd = cmd};
         return split_bt_invoke_behavior_payload(wrapper);
     }
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK: {
+        // Another sync will follow soon, so drop this one rather than a queued command if full.
+        struct central_cmd_wrapper wrapper = {.source = source, .cmd = cmd};
+        int err = k_msgq_put(&zmk_split_central_split_run_msgq, &wrapper, K_NO_WAIT);
+        if (err) {
+            return err;
+        }
+
+        k_work_submit_to_queue(&split_central_split_run_q, &split_central_split_run_work);
+        return 0;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS: {
+        // Another check will follow, so drop this one rather than a queued command if full.
+        struct central_cmd_wrapper wrapper = {.source = source, .cmd = cmd};
+        int err = k_msgq_put(&zmk_split_central_split_run_msgq, &wrapper, K_NO_WAIT);
+        if (err) {
+            return err;
+        }
+
+        k_work_submit_to_queue(&split_central_split_run_q, &split_central_split_run_work);
+        return 0;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_POLL_EVENTS:
         return -ENOTSUP;
     default:
@@ -26,6 +26,10 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/split/bluetooth/uuid.h>
 #include <zmk/split/bluetooth/service.h>
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+#include <zmk/varint.h>
+#endif
+
 #include "peripheral.h"
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
@@ -49,19 +53,50 @@ static void split_svc_sensor_state_ccc(const struct bt_gatt_attr *attr, uint16_t
 }
 #endif /* ZMK_KEYMAP_HAS_SENSORS */
 
-#define POS_STATE_LEN 16
-
 static uint8_t num_of_positions = ZMK_KEYMAP_LEN;
-static uint8_t position_state[POS_STATE_LEN];
 
 static struct zmk_split_run_behavior_payload behavior_run_payload;
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
+struct position_snapshot {
+    uint8_t seq;
+    uint8_t state[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+} __packed;
+
+// The state the central will have once it has applied every notification sent so far.
+static struct position_snapshot notified_positions;
+static struct k_spinlock notified_positions_lock;
+
+// The current state, used to resync if a delta couldn't be queued.
+static uint8_t current_positions[DIV_ROUND_UP(ZMK_KEYMAP_LEN, 8)];
+static bool position_deltas_overflowed;
+
+static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
+                                   void *buf, uint16_t len, uint16_t offset) {
+    struct position_snapshot snapshot;
+
+    k_spinlock_key_t key = k_spin_lock(&notified_positions_lock);
+    snapshot = notified_positions;
+    k_spin_unlock(&notified_positions_lock, key);
+
+    return bt_gatt_attr_read(conn, attrs, buf, len, offset, &snapshot, sizeof(snapshot));
+}
+
+#else
+
+#define POS_STATE_LEN 16
+
+static uint8_t position_state[POS_STATE_LEN];
+
 static ssize_t split_svc_pos_state(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                    void *buf, uint16_t len, uint16_t offset) {
     return bt_gatt_attr_read(conn, attrs, buf, len, offset, &position_state,
                              sizeof(position_state));
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
 static ssize_t split_svc_run_behavior(struct bt_conn *conn, const struct bt_gatt_attr *attrs,
                                       const void *buf, uint16_t len, uint16_t offset,
                                       uint8_t flags);
@@ -139,6 +174,69 @@ static ssize_t split_svc_get_selected_phys_layout(struct bt_conn *conn,
     return bt_gatt_attr_read(conn, attrs, buf, len, offset, &selected, sizeof(selected));
 }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+static void split_svc_clock_sync_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
+    LOG_DBG("value %d", value);
+}
+
+static ssize_t split_svc_clock_sync(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                    const void *buf, uint16_t len, uint16_t offset, uint8_t flags) {
+    struct zmk_split_clock_sync_request request;
+
+    if (offset != 0 || len != sizeof(request)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    memcpy(&request, buf, sizeof(request));
+
+    // Handled right away, rather than from a work queue, to keep the reply's timestamp as close
+    // as possible to the request arriving.
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK,
+        .data = {.sync_clock = {.central_time = request.central_time}},
+    };
+
+    zmk_split_transport_peripheral_command_handler(zmk_split_transport_peripheral_bt(), cmd);
+
+    return len;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
+static ssize_t split_svc_run_behaviors(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                       const void *buf, uint16_t len, uint16_t offset,
+                                       uint8_t flags) {
+    struct zmk_split_transport_central_command cmd = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS,
+        .data = {.invoke_behaviors = {.len = len}},
+    };
+
+    if (offset != 0 || len > sizeof(cmd.data.invoke_behaviors.buf)) {
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    memcpy(cmd.data.invoke_behaviors.buf, buf, len);
+
+    zmk_split_transport_peripheral_command_handler(zmk_split_transport_peripheral_bt(), cmd);
+
+    return len;
+}
+
+static ssize_t split_svc_behavior_ids(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+                                      void *buf, uint16_t len, uint16_t offset) {
+    struct zmk_split_behavior_ids ids = {
+        .crc16_ids = IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_ID_TYPE_CRC16),
+        .table_hash = sys_cpu_to_le32(zmk_behavior_local_id_table_hash()),
+    };
+
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &ids, sizeof(ids));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
 
 static void split_input_events_ccc(const struct bt_gatt_attr *attr, uint16_t value) {
@@ -180,9 +278,15 @@ ssize_t bt_gatt_attr_read_input_split_cpf(struct bt_conn *conn, const struct bt_
 
 BT_GATT_SERVICE_DEFINE(
     split_svc, BT_GATT_PRIMARY_SERVICE(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_SERVICE_UUID)),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_DELTAS_UUID),
+                           BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
+                           split_svc_pos_state, NULL, NULL),
+#else
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_POSITION_STATE_UUID),
                            BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_pos_state, NULL, &position_state),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
     BT_GATT_CCC(split_svc_pos_state_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
     BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIOR_UUID),
                            BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
@@ -205,12 +309,163 @@ BT_GATT_SERVICE_DEFINE(
                            BT_GATT_CHRC_WRITE | BT_GATT_CHRC_READ,
                            BT_GATT_PERM_WRITE_ENCRYPT | BT_GATT_PERM_READ_ENCRYPT,
                            split_svc_get_selected_phys_layout, split_svc_select_phys_layout,
-                           NULL), );
+                           NULL),
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_CLOCK_SYNC_UUID),
+                           BT_GATT_CHRC_WRITE_WITHOUT_RESP | BT_GATT_CHRC_NOTIFY,
+                           BT_GATT_PERM_WRITE_ENCRYPT, NULL, split_svc_clock_sync, NULL),
+    BT_GATT_CCC(split_svc_clock_sync_ccc, BT_GATT_PERM_READ_ENCRYPT | BT_GATT_PERM_WRITE_ENCRYPT),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_RUN_BEHAVIORS_UUID),
+                           BT_GATT_CHRC_WRITE_WITHOUT_RESP, BT_GATT_PERM_WRITE_ENCRYPT, NULL,
+                           split_svc_run_behaviors, NULL),
+    BT_GATT_CHARACTERISTIC(BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_BEHAVIOR_IDS_UUID),
+                           BT_GATT_CHRC_READ, BT_GATT_PERM_READ_ENCRYPT, split_svc_behavior_ids,
+                           NULL, NULL),
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+);
 
 K_THREAD_STACK_DEFINE(service_q_stack, CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_STACK_SIZE);
 
 struct k_work_q service_work_q;
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
+struct position_delta {
+    uint32_t position;
+    bool pressed;
+    int64_t timestamp;
+};
+
+K_MSGQ_DEFINE(position_state_msgq, sizeof(struct position_delta),
+              CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
+
+// Each entry is at least two bytes, so this is the most that fit in one notification.
+#define MAX_DELTAS_PER_NOTIFICATION                                                                \
+    ((ZMK_SPLIT_POSITION_DELTAS_MAX_LEN - ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN) / 2)
+
+struct position_deltas_batch {
+    // Uptime the entries' ages are relative to.
+    int64_t time;
+    uint8_t buf[ZMK_SPLIT_POSITION_DELTAS_MAX_LEN];
+    size_t len;
+    struct position_delta deltas[MAX_DELTAS_PER_NOTIFICATION];
+    size_t count;
+};
+
+static void send_position_deltas_batch(struct position_deltas_batch *batch) {
+    k_spinlock_key_t key = k_spin_lock(&notified_positions_lock);
+    for (size_t i = 0; i < batch->count; i++) {
+        WRITE_BIT(notified_positions.state[batch->deltas[i].position / 8],
+                  batch->deltas[i].position % 8, batch->deltas[i].pressed);
+    }
+
+    batch->buf[0] = ++notified_positions.seq;
+    k_spin_unlock(&notified_positions_lock, key);
+
+    sys_put_le32((uint32_t)batch->time, &batch->buf[1]);
+
+    // If this fails, the central will see a gap in the sequence numbers and read a snapshot.
+    int err = bt_gatt_notify(NULL, &split_svc.attrs[1], batch->buf, batch->len);
+    if (err) {
+        LOG_DBG("Error notifying %d", err);
+    }
+
+    batch->len = ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN;
+    batch->count = 0;
+}
+
+/**
+ * Throws away the queued deltas and skips a sequence number, so the central reads the current
+ * state as a snapshot.
+ */
+static void resync_position_deltas(void) {
+    struct position_deltas_batch batch = {
+        .time = k_uptime_get(),
+        .len = ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN,
+    };
+
+    k_spinlock_key_t key = k_spin_lock(&notified_positions_lock);
+    k_msgq_purge(&position_state_msgq);
+    memcpy(notified_positions.state, current_positions, sizeof(current_positions));
+    notified_positions.seq++;
+    position_deltas_overflowed = false;
+    k_spin_unlock(&notified_positions_lock, key);
+
+    send_position_deltas_batch(&batch);
+}
+
+void send_position_state_callback(struct k_work *work) {
+    struct position_deltas_batch batch = {
+        .time = k_uptime_get(),
+        .len = ZMK_SPLIT_POSITION_DELTAS_HEADER_LEN,
+    };
+    struct position_delta delta;
+
+    if (position_deltas_overflowed) {
+        resync_position_deltas();
+        return;
+    }
+
+    while (k_msgq_peek(&position_state_msgq, &delta) == 0) {
+        uint8_t entry[2 * ZMK_VARINT_MAX_LEN];
+        uint32_t age = CLAMP(batch.time - delta.timestamp, 0, UINT32_MAX);
+        int len = zmk_varint_encode(
+            ZMK_SPLIT_POSITION_DELTA_KEY(delta.position, delta.pressed), entry, sizeof(entry));
+        len += zmk_varint_encode(age, entry + len, sizeof(entry) - len);
+
+        if (batch.len + len > sizeof(batch.buf) || batch.count == ARRAY_SIZE(batch.deltas)) {
+            send_position_deltas_batch(&batch);
+            continue;
+        }
+
+        k_msgq_get(&position_state_msgq, &delta, K_NO_WAIT);
+
+        memcpy(batch.buf + batch.len, entry, len);
+        batch.len += len;
+        batch.deltas[batch.count++] = delta;
+    }
+
+    if (batch.count > 0) {
+        send_position_deltas_batch(&batch);
+    }
+};
+
+K_WORK_DEFINE(service_position_notify_work, send_position_state_callback);
+
+static int zmk_split_bt_position_changed(uint32_t position, bool pressed, int64_t timestamp) {
+    if (position >= ZMK_KEYMAP_LEN) {
+        LOG_ERR("Position %d is outside of the keymap", position);
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&notified_positions_lock);
+    WRITE_BIT(current_positions[position / 8], position % 8, pressed);
+    k_spin_unlock(&notified_positions_lock, key);
+
+    struct position_delta delta = {
+        .position = position,
+        .pressed = pressed,
+        .timestamp = timestamp,
+    };
+    int err = k_msgq_put(&position_state_msgq, &delta, K_MSEC(100));
+    if (err) {
+        // Dropping a delta would leave the central with the wrong state, so have the central
+        // resync from a snapshot instead.
+        LOG_WRN("Position delta message queue full, resyncing (%d)", err);
+        key = k_spin_lock(&notified_positions_lock);
+        position_deltas_overflowed = true;
+        k_spin_unlock(&notified_positions_lock, key);
+    }
+
+    k_work_submit_to_queue(&service_work_q, &service_position_notify_work);
+
+    return err;
+}
+
+#else
+
 K_MSGQ_DEFINE(position_state_msgq, sizeof(char[POS_STATE_LEN]),
               CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
 
@@ -248,16 +503,18 @@ int send_position_state() {
     return 0;
 }
 
-static int zmk_split_bt_position_pressed(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, true);
-    return send_position_state();
-}
+static int zmk_split_bt_position_changed(uint32_t position, bool pressed, int64_t timestamp) {
+    if (position >= POS_STATE_LEN * 8) {
+        LOG_ERR("Position %d does not fit in the position state bitmap", position);
+        return -EINVAL;
+    }
 
-static int zmk_split_bt_position_released(uint8_t position) {
-    WRITE_BIT(position_state[position / 8], position % 8, false);
+    WRITE_BIT(position_state[position / 8], position % 8, pressed);
     return send_position_state();
 }
 
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_POSITION_DELTAS)
+
 #if ZMK_KEYMAP_HAS_SENSORS
 K_MSGQ_DEFINE(sensor_state_msgq, sizeof(struct sensor_event),
               CONFIG_ZMK_SPLIT_BLE_PERIPHERAL_POSITION_QUEUE_SIZE, 4);
@@ -334,6 +591,37 @@ static int zmk_split_bt_report_input(uint8_t reg, uint8_t type, uint16_t code, i
 
 #endif /* IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT) */
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+static struct zmk_split_clock_sync_response clock_sync_response;
+
+static void send_clock_sync_callback(struct k_work *work) {
+    const struct bt_gatt_attr *attr =
+        bt_gatt_find_by_uuid(split_svc.attrs, split_svc.attr_count,
+                             BT_UUID_DECLARE_128(ZMK_SPLIT_BT_CHAR_CLOCK_SYNC_UUID));
+
+    int err = bt_gatt_notify(NULL, attr, &clock_sync_response, sizeof(clock_sync_response));
+    if (err) {
+        LOG_DBG("Error notifying clock sync %d", err);
+    }
+}
+
+K_WORK_DEFINE(service_clock_sync_notify_work, send_clock_sync_callback);
+
+static int zmk_split_bt_clock_synced(int64_t central_time, int64_t peripheral_time) {
+    // Only the latest reply matters, so a newer one can replace one that hasn't been sent yet.
+    clock_sync_response = (struct zmk_split_clock_sync_response){
+        .central_time = central_time,
+        .peripheral_time = peripheral_time,
+    };
+
+    k_work_submit_to_queue(&service_work_q, &service_clock_sync_notify_work);
+
+    return 0;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
 static int service_init(void) {
     static const struct k_work_queue_config queue_config = {
         .name = "Split Peripheral Notification Queue"};
@@ -349,11 +637,9 @@ int zmk_split_transport_peripheral_bt_report_event(
     const struct zmk_split_transport_peripheral_event *ev) {
     switch (ev->type) {
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT:
-        if (ev->data.key_position_event.pressed) {
-            zmk_split_bt_position_pressed(ev->data.key_position_event.position);
-        } else {
-            zmk_split_bt_position_released(ev->data.key_position_event.position);
-        }
+        zmk_split_bt_position_changed(ev->data.key_position_event.position,
+                                      ev->data.key_position_event.pressed,
+                                      ev->data.key_position_event.timestamp);
         break;
 #if ZMK_KEYMAP_HAS_SENSORS
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT:
@@ -375,6 +661,18 @@ int zmk_split_transport_peripheral_bt_report_event(
         // The BLE transport uses standard BAS service for propagation, so just return success here.
         return 0;
 #endif
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT:
+        return zmk_split_bt_clock_synced(ev->data.clock_sync_event.central_time,
+                                         ev->data.clock_sync_event.peripheral_time);
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT:
+        // The central reads the behavior IDs characteristic instead.
+        return 0;
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
     default:
         LOG_WRN("Unhandled event type %d", ev->type);
         return -ENOTSUP;
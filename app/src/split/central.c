@@ -13,11 +13,18 @@
 #include <zmk/pointing/input_split.h>
 
 #include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
 
 #include <zmk/event_manager.h>
 #include <zmk/events/battery_state_changed.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/sensor_event.h>
+#include <zmk/timer_wheel.h>
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+#include <zmk/split/invoke_behaviors.h>
+#include <zmk/workqueue.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
 
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
@@ -29,6 +36,416 @@ static uint8_t peripheral_battery_levels[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT] = {
 
 #endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+// Worst case drift between the central's and a peripheral's clocks, used to age old measurements.
+#define CLOCK_DRIFT_PPM 100
+
+struct clock_sync_state {
+    bool valid;
+    int64_t offset_us;
+    uint32_t round_trip_us;
+    // Central uptime in microseconds when the offset was measured.
+    int64_t measured_at_us;
+};
+
+static struct clock_sync_state clock_syncs[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+static struct k_spinlock clock_sync_lock;
+
+// Syncs sent at the retry interval to each peripheral since it became available, without a reply.
+// Only used by clock_sync_work.
+static uint8_t clock_sync_retries[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+
+static inline int64_t clock_sync_now_us(void) { return k_ticks_to_us_floor64(k_uptime_ticks()); }
+
+static uint32_t clock_sync_error_us(const struct clock_sync_state *state, int64_t now_us) {
+    int64_t drift_us = (now_us - state->measured_at_us) * CLOCK_DRIFT_PPM / 1000000;
+
+    return MIN(state->round_trip_us / 2 + MAX(drift_us, 0), UINT32_MAX);
+}
+
+static void clock_sync_add_sample(uint8_t source, int64_t central_time, int64_t peripheral_time,
+                                  int64_t received_time) {
+    int64_t round_trip = received_time - central_time;
+    if (round_trip < 0 || round_trip > UINT32_MAX) {
+        LOG_WRN("Ignoring clock sync reply with round trip of %lld us", round_trip);
+        return;
+    }
+
+    // The peripheral read its clock somewhere within the round trip, so assume it was halfway.
+    int64_t offset = peripheral_time - (central_time + round_trip / 2);
+
+    k_spinlock_key_t key = k_spin_lock(&clock_sync_lock);
+
+    struct clock_sync_state *state = &clock_syncs[source];
+    uint32_t error = state->valid ? clock_sync_error_us(state, received_time) : UINT32_MAX;
+
+    // Keep whichever measurement bounds the offset more tightly. If the two can't both be right,
+    // the peripheral's clock has been reset, so the old one is useless.
+    bool better = round_trip / 2 <= error;
+    bool inconsistent = state->valid && llabs(offset - state->offset_us) > round_trip / 2 + error;
+
+    if (better || inconsistent) {
+        *state = (struct clock_sync_state){
+            .valid = true,
+            .offset_us = offset,
+            .round_trip_us = round_trip,
+            .measured_at_us = received_time,
+        };
+    }
+
+    k_spin_unlock(&clock_sync_lock, key);
+
+    if (better || inconsistent) {
+        LOG_DBG("Peripheral %d clock offset %lld us, +/- %lld us", source, offset, round_trip / 2);
+    }
+}
+
+int zmk_split_central_get_clock_offset(uint8_t source,
+                                       struct zmk_split_central_clock_offset *offset) {
+    if (source >= ARRAY_SIZE(clock_syncs)) {
+        return -EINVAL;
+    }
+
+    int ret = 0;
+    int64_t now_us = clock_sync_now_us();
+    k_spinlock_key_t key = k_spin_lock(&clock_sync_lock);
+
+    const struct clock_sync_state *state = &clock_syncs[source];
+    if (state->valid) {
+        *offset = (struct zmk_split_central_clock_offset){
+            .offset_us = state->offset_us,
+            .error_us = clock_sync_error_us(state, now_us),
+            .round_trip_us = state->round_trip_us,
+        };
+    } else {
+        ret = -ENODATA;
+    }
+
+    k_spin_unlock(&clock_sync_lock, key);
+
+    return ret;
+}
+
+int zmk_split_central_peripheral_time_to_local(uint8_t source, uint32_t peripheral_time,
+                                               int64_t *local_time) {
+    if (source >= ARRAY_SIZE(clock_syncs)) {
+        return -EINVAL;
+    }
+
+    int64_t now_us = clock_sync_now_us();
+    k_spinlock_key_t key = k_spin_lock(&clock_sync_lock);
+    bool valid = clock_syncs[source].valid;
+    int64_t offset_us = clock_syncs[source].offset_us;
+    k_spin_unlock(&clock_sync_lock, key);
+
+    if (!valid) {
+        return -ENODATA;
+    }
+
+    // Restore the high bits by assuming the time is within 24 days of the peripheral's uptime.
+    int64_t peripheral_now = (now_us + offset_us) / 1000;
+    int64_t full_time = peripheral_now + (int32_t)(peripheral_time - (uint32_t)peripheral_now);
+
+    // An event can't have happened after it arrived, whatever the offset's error.
+    *local_time = MIN(full_time - offset_us / 1000, now_us / 1000);
+
+    return 0;
+}
+
+static void clock_sync_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(clock_sync_work, clock_sync_work_cb);
+
+static void clock_sync_work_cb(struct k_work *work) {
+    uint8_t source_ids[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+    bool available[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT] = {false};
+    int count = 0;
+
+    if (active_transport && active_transport->api->get_available_source_ids &&
+        active_transport->api->send_command) {
+        count = active_transport->api->get_available_source_ids(source_ids);
+    }
+
+    for (int i = 0; i < count; i++) {
+        struct zmk_split_transport_central_command command = {
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK,
+            .data = {.sync_clock = {.central_time = clock_sync_now_us()}},
+        };
+
+        available[source_ids[i]] = true;
+        active_transport->api->send_command(source_ids[i], command);
+    }
+
+    bool all_synced = true;
+    k_spinlock_key_t key = k_spin_lock(&clock_sync_lock);
+
+    for (int i = 0; i < ARRAY_SIZE(clock_syncs); i++) {
+        if (!available[i]) {
+            // The peripheral may come back with a different clock.
+            clock_syncs[i].valid = false;
+            clock_sync_retries[i] = 0;
+        } else if (!clock_syncs[i].valid &&
+                   clock_sync_retries[i] < CONFIG_ZMK_SPLIT_CLOCK_SYNC_MAX_RETRIES) {
+            // A peripheral which never replies, e.g. one with older firmware, falls back to the
+            // normal interval once it has had enough chances.
+            clock_sync_retries[i]++;
+            all_synced = false;
+        }
+    }
+
+    k_spin_unlock(&clock_sync_lock, key);
+
+    k_work_schedule(&clock_sync_work,
+                    K_MSEC(all_synced ? CONFIG_ZMK_SPLIT_CLOCK_SYNC_INTERVAL
+                                      : CONFIG_ZMK_SPLIT_CLOCK_SYNC_RETRY_INTERVAL));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+static int send_behavior_by_name(uint8_t source, const char *behavior_dev, uint32_t param1,
+                                 uint32_t param2, uint32_t position, uint8_t event_source,
+                                 bool state) {
+    if (!active_transport || !active_transport->api || !active_transport->api->send_command) {
+        return -ENODEV;
+    }
+
+    struct zmk_split_transport_central_command command =
+        (struct zmk_split_transport_central_command){
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
+            .data =
+                {
+                    .invoke_behavior =
+                        {
+                            .param1 = param1,
+                            .param2 = param2,
+                            .position = position,
+                            .event_source = event_source,
+                            .state = state ? 1 : 0,
+                        },
+                },
+        };
+
+    const size_t payload_dev_size = sizeof(command.data.invoke_behavior.behavior_dev);
+    if (strlcpy(command.data.invoke_behavior.behavior_dev, behavior_dev, payload_dev_size) >=
+        payload_dev_size) {
+        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
+                behavior_dev, command.data.invoke_behavior.behavior_dev);
+    }
+
+    return active_transport->api->send_command(source, command);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
+BUILD_ASSERT(3 + 3 * ZMK_VARINT_MAX_LEN <= ZMK_SPLIT_INVOKE_BEHAVIORS_MAX_LEN,
+             "A single invoke behaviors entry must always fit in a command");
+
+struct behavior_ids_state {
+    // Whether the peripheral has replied since it last became available.
+    bool replied;
+    // Whether the peripheral's last reply showed it maps local IDs to the same behaviors.
+    bool agreed;
+    // Invocations which haven't been sent to the peripheral yet.
+    uint8_t batch_len;
+    uint8_t batch[ZMK_SPLIT_INVOKE_BEHAVIORS_MAX_LEN];
+};
+
+static struct behavior_ids_state behavior_ids[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+
+// A mutex rather than a spinlock, so batches are sent while it is held and so stay in order.
+static K_MUTEX_DEFINE(behavior_ids_lock);
+
+// Must be called with behavior_ids_lock held.
+static int flush_behaviors(uint8_t source) {
+    struct behavior_ids_state *state = &behavior_ids[source];
+
+    if (state->batch_len == 0) {
+        return 0;
+    }
+
+    struct zmk_split_transport_central_command command = {
+        .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS,
+        .data = {.invoke_behaviors = {.len = state->batch_len}},
+    };
+
+    memcpy(command.data.invoke_behaviors.buf, state->batch, state->batch_len);
+    state->batch_len = 0;
+
+    if (!active_transport || !active_transport->api->send_command) {
+        return -ENODEV;
+    }
+
+    return active_transport->api->send_command(source, command);
+}
+
+// Must be called with behavior_ids_lock held. Sends anything batched for the peripheral by name
+// instead, once its local IDs can't be relied on any more. Entries which can't be sent, e.g.
+// because the peripheral is gone, are logged, since a lost release can leave a behavior held.
+static void resend_batch_by_name(uint8_t source) {
+    struct behavior_ids_state *state = &behavior_ids[source];
+    int offset = 0;
+
+    while (offset < state->batch_len) {
+        struct zmk_split_invoke_behaviors_entry entry;
+        int len = zmk_split_invoke_behaviors_decode(state->batch + offset,
+                                                    state->batch_len - offset, &entry);
+        if (len < 0) {
+            LOG_ERR("Dropped malformed queued behavior invocations for peripheral %d", source);
+            break;
+        }
+
+        offset += len;
+
+        const char *name = zmk_behavior_find_behavior_name_from_local_id(entry.local_id);
+        int err = -ENODEV;
+
+        if (name) {
+            err = send_behavior_by_name(source, name, entry.param1, entry.param2, entry.position,
+                                        ZMK_POSITION_STATE_CHANGE_SOURCE_LOCAL, entry.pressed);
+        }
+
+        if (err < 0) {
+            LOG_WRN("Dropped %s of behavior %d at position %d for peripheral %d (%d)",
+                    entry.pressed ? "press" : "release", entry.local_id, entry.position, source,
+                    err);
+        }
+    }
+
+    state->batch_len = 0;
+}
+
+static void flush_behaviors_work_cb(struct k_work *work) {
+    k_mutex_lock(&behavior_ids_lock, K_FOREVER);
+
+    for (int i = 0; i < ARRAY_SIZE(behavior_ids); i++) {
+        int err = flush_behaviors(i);
+        if (err < 0) {
+            LOG_WRN("Failed to send behaviors to peripheral %d (%d)", i, err);
+        }
+    }
+
+    k_mutex_unlock(&behavior_ids_lock);
+}
+
+static K_WORK_DEFINE(flush_behaviors_work, flush_behaviors_work_cb);
+
+// Adds an invocation to the peripheral's next batch, which is sent once whatever is invoking
+// behaviors right now is done, so a burst of invocations goes out as one command.
+//
+// @returns -EAGAIN if the behavior has to be sent by name instead.
+static int queue_behavior_by_local_id(uint8_t source, const struct zmk_behavior_binding *binding,
+                                      struct zmk_behavior_binding_event event, bool state) {
+    if (source >= ARRAY_SIZE(behavior_ids)) {
+        return -EINVAL;
+    }
+
+    struct zmk_split_invoke_behaviors_entry entry = {
+        .local_id = zmk_behavior_get_local_id(binding->behavior_dev),
+        .position = event.position,
+        .pressed = state,
+        .param1 = binding->param1,
+        .param2 = binding->param2,
+    };
+
+    int ret = 0;
+    struct behavior_ids_state *ids = &behavior_ids[source];
+
+    k_mutex_lock(&behavior_ids_lock, K_FOREVER);
+
+    if (!ids->agreed || entry.local_id == UINT16_MAX) {
+        // Anything already batched has to go first to keep invocations in order.
+        flush_behaviors(source);
+        k_mutex_unlock(&behavior_ids_lock);
+        return -EAGAIN;
+    }
+
+    int len = zmk_split_invoke_behaviors_encode(&entry, ids->batch + ids->batch_len,
+                                                sizeof(ids->batch) - ids->batch_len);
+    if (len < 0) {
+        ret = flush_behaviors(source);
+        len = zmk_split_invoke_behaviors_encode(&entry, ids->batch, sizeof(ids->batch));
+    }
+
+    ids->batch_len += len;
+
+    k_mutex_unlock(&behavior_ids_lock);
+
+    k_work_submit_to_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &flush_behaviors_work);
+
+    return ret;
+}
+
+static void behavior_ids_reply(uint8_t source, bool crc16_ids, uint32_t table_hash) {
+    // IDs hashed from names agree for every behavior both sides have, whichever those are.
+    bool agreed = (crc16_ids && IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_ID_TYPE_CRC16)) ||
+                  table_hash == zmk_behavior_local_id_table_hash();
+
+    k_mutex_lock(&behavior_ids_lock, K_FOREVER);
+
+    if (agreed != behavior_ids[source].agreed) {
+        LOG_INF("Peripheral %d behavior local IDs %s", source, agreed ? "match" : "differ");
+    }
+
+    if (!agreed) {
+        resend_batch_by_name(source);
+    }
+
+    behavior_ids[source].replied = true;
+    behavior_ids[source].agreed = agreed;
+
+    k_mutex_unlock(&behavior_ids_lock);
+}
+
+static void behavior_ids_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(behavior_ids_work, behavior_ids_work_cb);
+
+static void behavior_ids_work_cb(struct k_work *work) {
+    uint8_t source_ids[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT];
+    bool available[ZMK_SPLIT_CENTRAL_PERIPHERAL_COUNT] = {false};
+    int count = 0;
+
+    if (active_transport && active_transport->api->get_available_source_ids &&
+        active_transport->api->send_command) {
+        count = active_transport->api->get_available_source_ids(source_ids);
+    }
+
+    for (int i = 0; i < count; i++) {
+        struct zmk_split_transport_central_command command = {
+            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS,
+        };
+
+        available[source_ids[i]] = true;
+        active_transport->api->send_command(source_ids[i], command);
+    }
+
+    bool all_replied = true;
+
+    k_mutex_lock(&behavior_ids_lock, K_FOREVER);
+
+    for (int i = 0; i < ARRAY_SIZE(behavior_ids); i++) {
+        if (!available[i]) {
+            // The peripheral may come back with different firmware.
+            resend_batch_by_name(i);
+            behavior_ids[i].replied = false;
+            behavior_ids[i].agreed = false;
+        } else if (!behavior_ids[i].replied) {
+            all_replied = false;
+        }
+    }
+
+    k_mutex_unlock(&behavior_ids_lock);
+
+    // Once a peripheral has answered, whether or not it agrees, it is only checked again in case
+    // its firmware has changed. Differing IDs are expected, e.g. with Studio on the central.
+    k_work_schedule(&behavior_ids_work,
+                    K_MSEC(all_replied ? CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS_CHECK_INTERVAL
+                                       : CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS_RETRY_INTERVAL));
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 int zmk_split_transport_central_peripheral_event_handler(
     const struct zmk_split_transport_central *transport, uint8_t source,
     struct zmk_split_transport_peripheral_event ev) {
@@ -43,7 +460,9 @@ int zmk_split_transport_central_peripheral_event_handler(
                                                       .position =
                                                           ev.data.key_position_event.position,
                                                       .state = ev.data.key_position_event.pressed,
-                                                      .timestamp = k_uptime_get()};
+                                                      .timestamp =
+                                                          ev.data.key_position_event.timestamp};
+        zmk_timer_wheel_expire(state_ev.timestamp);
         return raise_zmk_position_state_changed(state_ev);
     }
 #if IS_ENABLED(CONFIG_ZMK_INPUT_SPLIT)
@@ -63,6 +482,29 @@ int zmk_split_transport_central_peripheral_event_handler(
         return raise_zmk_peripheral_battery_state_changed(battery_ev);
     }
 #endif
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT: {
+        if (source >= ARRAY_SIZE(clock_syncs)) {
+            return -EINVAL;
+        }
+
+        clock_sync_add_sample(source, ev.data.clock_sync_event.central_time,
+                              ev.data.clock_sync_event.peripheral_time,
+                              ev.data.clock_sync_event.received_time);
+        return 0;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT: {
+        if (source >= ARRAY_SIZE(behavior_ids)) {
+            return -EINVAL;
+        }
+
+        behavior_ids_reply(source, ev.data.behavior_ids_event.crc16_ids,
+                           ev.data.behavior_ids_event.table_hash);
+        return 0;
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_SENSOR_EVENT: {
         struct zmk_sensor_event sensor_ev = {.sensor_index = ev.data.sensor_event.sensor_index,
                                              .channel_data_size = 1,
@@ -84,30 +526,15 @@ int zmk_split_central_invoke_behavior(uint8_t source, struct zmk_behavior_bindin
         return -ENODEV;
     }
 
-    struct zmk_split_transport_central_command command =
-        (struct zmk_split_transport_central_command){
-            .type = ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIOR,
-            .data =
-                {
-                    .invoke_behavior =
-                        {
-                            .param1 = binding->param1,
-                            .param2 = binding->param2,
-                            .position = event.position,
-                            .event_source = event.source,
-                            .state = state ? 1 : 0,
-                        },
-                },
-        };
-
-    const size_t payload_dev_size = sizeof(command.data.invoke_behavior.behavior_dev);
-    if (strlcpy(command.data.invoke_behavior.behavior_dev, binding->behavior_dev,
-                payload_dev_size) >= payload_dev_size) {
-        LOG_ERR("Truncated behavior label %s to %s before invoking peripheral behavior",
-                binding->behavior_dev, command.data.invoke_behavior.behavior_dev);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    int ret = queue_behavior_by_local_id(source, binding, event, state);
+    if (ret != -EAGAIN) {
+        return ret;
     }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
 
-    return active_transport->api->send_command(source, command);
+    return send_behavior_by_name(source, binding->behavior_dev, binding->param1, binding->param2,
+                                 event.position, event.source, state);
 };
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_PERIPHERAL_HID_INDICATORS)
@@ -221,6 +648,14 @@ static int central_init(void) {
         t->api->set_status_callback(transport_status_changed_cb);
     }
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    k_work_schedule(&clock_sync_work, K_MSEC(CONFIG_ZMK_SPLIT_CLOCK_SYNC_RETRY_INTERVAL));
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    k_work_schedule(&behavior_ids_work, K_MSEC(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS_RETRY_INTERVAL));
+#endif
+
     return select_first_available_transport();
 }
 
@@ -8,6 +8,7 @@
 
 #include <zmk/stdlib.h>
 #include <zmk/split/transport/peripheral.h>
+#include <zmk/split/peripheral.h>
 
 #include <drivers/behavior.h>
 #include <zmk/behavior.h>
@@ -22,6 +23,10 @@
 #include <zmk/events/hid_indicators_changed.h>
 #endif
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+#include <zmk/split/invoke_behaviors.h>
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 #include <zephyr/init.h>
 #include <zephyr/logging/log.h>
 
@@ -29,6 +34,56 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 const struct zmk_split_transport_peripheral *active_transport;
 
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
+static int invoke_behaviors(const uint8_t *buf, size_t len) {
+    int64_t timestamp = k_uptime_get();
+    int ret = 0;
+
+    for (size_t offset = 0; offset < len;) {
+        struct zmk_split_invoke_behaviors_entry entry;
+        int entry_len = zmk_split_invoke_behaviors_decode(buf + offset, len - offset, &entry);
+        if (entry_len < 0) {
+            LOG_WRN("Malformed invoke behaviors command");
+            return entry_len;
+        }
+
+        offset += entry_len;
+
+        struct zmk_behavior_binding binding = {
+            .param1 = entry.param1,
+            .param2 = entry.param2,
+            .behavior_dev = zmk_behavior_find_behavior_name_from_local_id(entry.local_id),
+        };
+
+        if (!binding.behavior_dev) {
+            LOG_ERR("No behavior with local ID %d", entry.local_id);
+            ret = -ENODEV;
+            continue;
+        }
+
+        LOG_DBG("%s with params %d %d: pressed? %d", binding.behavior_dev, binding.param1,
+                binding.param2, entry.pressed);
+        struct zmk_behavior_binding_event event = {.position = entry.position,
+                                                   .timestamp = timestamp};
+        int err;
+        if (entry.pressed) {
+            err = behavior_keymap_binding_pressed(&binding, event);
+        } else {
+            err = behavior_keymap_binding_released(&binding, event);
+        }
+
+        if (err) {
+            LOG_ERR("Failed to invoke behavior %s: %d", binding.behavior_dev, err);
+            ret = err;
+        }
+    }
+
+    return ret;
+}
+
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+
 int zmk_split_transport_peripheral_command_handler(
     const struct zmk_split_transport_peripheral *transport,
     struct zmk_split_transport_central_command cmd) {
@@ -66,6 +121,37 @@ int zmk_split_transport_peripheral_command_handler(
             .indicators = cmd.data.set_hid_indicators.indicators});
     }
 #endif
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK: {
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT,
+            .data = {.clock_sync_event = {
+                         .central_time = cmd.data.sync_clock.central_time,
+                         .peripheral_time = k_ticks_to_us_floor64(k_uptime_ticks()),
+                     }}};
+
+        return zmk_split_peripheral_report_event(&ev);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS: {
+        if (cmd.data.invoke_behaviors.len > sizeof(cmd.data.invoke_behaviors.buf)) {
+            return -EINVAL;
+        }
+
+        return invoke_behaviors(cmd.data.invoke_behaviors.buf, cmd.data.invoke_behaviors.len);
+    }
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS: {
+        struct zmk_split_transport_peripheral_event ev = {
+            .type = ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT,
+            .data = {.behavior_ids_event = {
+                         .crc16_ids = IS_ENABLED(CONFIG_ZMK_BEHAVIOR_LOCAL_ID_TYPE_CRC16),
+                         .table_hash = zmk_behavior_local_id_table_hash(),
+                     }}};
+
+        return zmk_split_peripheral_report_event(&ev);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_BEHAVIOR_LOCAL_IDS)
     default:
         LOG_WRN("Unhandled command type %d", cmd.type);
         return -ENOTSUP;
@@ -154,6 +240,7 @@ int split_peripheral_listener(const zmk_event_t *eh) {
             .data = {.key_position_event = {
                          .position = pos_ev->position,
                          .pressed = pos_ev->state,
+                         .timestamp = pos_ev->timestamp,
                      }}};
 
         zmk_split_peripheral_report_event(&ev);
@@ -24,6 +24,7 @@ LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 #include <zmk/behavior.h>
 #include <zmk/sensors.h>
 #include <zmk/split/transport/central.h>
+#include <zmk/split/central.h>
 #include <zmk/event_manager.h>
 #include <zmk/events/position_state_changed.h>
 #include <zmk/events/sensor_event.h>
@@ -185,6 +186,14 @@ static ssize_t get_payload_data_size(const struct zmk_split_transport_central_co
         return sizeof(cmd->data.set_physical_layout);
     case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SET_HID_INDICATORS:
         return sizeof(cmd->data.set_hid_indicators);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_SYNC_CLOCK:
+        return sizeof(cmd->data.sync_clock);
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_INVOKE_BEHAVIORS:
+        // Only the used part of the buffer is sent.
+        return sizeof(cmd->data.invoke_behaviors.len) +
+               MIN(cmd->data.invoke_behaviors.len, sizeof(cmd->data.invoke_behaviors.buf));
+    case ZMK_SPLIT_TRANSPORT_CENTRAL_CMD_TYPE_CHECK_BEHAVIOR_IDS:
+        return 0;
     default:
         return -ENOTSUP;
     }
@@ -461,6 +470,28 @@ static void notify_transport_status(void) {
 
 #endif
 
+static void stamp_received_event(uint8_t source, struct zmk_split_transport_peripheral_event *ev) {
+    switch (ev->type) {
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_KEY_POSITION_EVENT: {
+        int64_t *timestamp = &ev->data.key_position_event.timestamp;
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+        if (zmk_split_central_peripheral_time_to_local(source, *timestamp, timestamp) == 0) {
+            break;
+        }
+#endif // IS_ENABLED(CONFIG_ZMK_SPLIT_CLOCK_SYNC)
+
+        *timestamp = k_uptime_get();
+        break;
+    }
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT:
+        ev->data.clock_sync_event.received_time = k_ticks_to_us_floor64(k_uptime_ticks());
+        break;
+    default:
+        break;
+    }
+}
+
 static void publish_events_work(struct k_work *work) {
 
 #if IS_HALF_DUPLEX_MODE
@@ -474,6 +505,7 @@ static void publish_events_work(struct k_work *work) {
             zmk_split_wired_get_item(&rx_buf, (uint8_t *)&env, sizeof(struct event_envelope));
         switch (item_err) {
         case 0:
+            stamp_received_event(env.payload.source, &env.payload.event);
             zmk_split_transport_central_peripheral_event_handler(&wired_central, env.payload.source,
                                                                  env.payload.event);
             break;
@@ -289,6 +289,12 @@ static ssize_t get_payload_data_size(const struct zmk_split_transport_peripheral
         return sizeof(evt->data.sensor_event);
     case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BATTERY_EVENT:
         return sizeof(evt->data.battery_event);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_CLOCK_SYNC_EVENT:
+        // The received time is last, and is filled in by the central.
+        return sizeof(evt->data.clock_sync_event) -
+               sizeof(evt->data.clock_sync_event.received_time);
+    case ZMK_SPLIT_TRANSPORT_PERIPHERAL_EVENT_TYPE_BEHAVIOR_IDS_EVENT:
+        return sizeof(evt->data.behavior_ids_event);
     default:
         return -ENOTSUP;
     }
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 The ZMK Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include <zmk/timer_wheel.h>
+#include <zmk/workqueue.h>
+
+#define WHEEL_SLOTS CONFIG_ZMK_TIMER_WHEEL_SLOTS
+
+BUILD_ASSERT(IS_POWER_OF_TWO(WHEEL_SLOTS), "CONFIG_ZMK_TIMER_WHEEL_SLOTS must be a power of two");
+
+#define SLOT_INIT(i, _) SYS_DLIST_STATIC_INIT(&slots[i])
+
+// Each pending timer is in the slot for its deadline, or for wheel_time if its deadline had
+// already passed when it was started.
+static sys_dlist_t slots[WHEEL_SLOTS] = {LISTIFY(WHEEL_SLOTS, SLOT_INIT, (, ))};
+
+// Expired timers whose handlers haven't been run yet.
+static sys_dlist_t expired = SYS_DLIST_STATIC_INIT(&expired);
+
+// All timers with deadlines before this have expired.
+static int64_t wheel_time;
+// No pending timer has a deadline before this.
+static int64_t next_deadline = INT64_MAX;
+static uint32_t pending_count;
+
+static void timer_wheel_work_cb(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(wheel_work, timer_wheel_work_cb);
+
+// Nothing here is locked. Timers are only touched from the input work queue, like the keymap and
+// behavior state that their handlers change.
+#define ASSERT_INPUT_THREAD()                                                                      \
+    __ASSERT(k_current_get() == &zmk_workqueue_get(ZMK_WORK_CLASS_INPUT)->thread,                  \
+             "Timers must only be used from ZMK_WORK_CLASS_INPUT work")
+
+static inline sys_dlist_t *slot_for(int64_t time) { return &slots[time & (WHEEL_SLOTS - 1)]; }
+
+static void schedule(int64_t deadline) {
+    next_deadline = deadline;
+
+    if (deadline == INT64_MAX) {
+        k_work_cancel_delayable(&wheel_work);
+        return;
+    }
+
+    k_work_reschedule_for_queue(zmk_workqueue_get(ZMK_WORK_CLASS_INPUT), &wheel_work,
+                                K_MSEC(MAX(deadline - k_uptime_get(), 0)));
+}
+
+static int64_t find_next_deadline(void) {
+    struct zmk_timer *timer;
+
+    if (pending_count == 0) {
+        return INT64_MAX;
+    }
+
+    // A timer due within one turn of the wheel is in the slot for its own deadline, so the first
+    // one found walking forward from wheel_time is the next to expire.
+    for (int64_t time = wheel_time; time < wheel_time + WHEEL_SLOTS; time++) {
+        SYS_DLIST_FOR_EACH_CONTAINER(slot_for(time), timer, node) {
+            if (timer->deadline <= time) {
+                return timer->deadline;
+            }
+        }
+    }
+
+    int64_t deadline = INT64_MAX;
+
+    for (int i = 0; i < WHEEL_SLOTS; i++) {
+        SYS_DLIST_FOR_EACH_CONTAINER(&slots[i], timer, node) {
+            deadline = MIN(deadline, timer->deadline);
+        }
+    }
+
+    return deadline;
+}
+
+void zmk_timer_init(struct zmk_timer *timer, zmk_timer_handler_t handler) {
+    sys_dnode_init(&timer->node);
+    timer->deadline = 0;
+    timer->handler = handler;
+}
+
+void zmk_timer_start(struct zmk_timer *timer, int64_t deadline) {
+    ASSERT_INPUT_THREAD();
+
+    if (zmk_timer_is_pending(timer)) {
+        sys_dlist_remove(&timer->node);
+    } else {
+        pending_count++;
+    }
+
+    timer->deadline = deadline;
+    sys_dlist_append(slot_for(MAX(deadline, wheel_time)), &timer->node);
+
+    if (deadline < next_deadline) {
+        schedule(deadline);
+    }
+}
+
+bool zmk_timer_stop(struct zmk_timer *timer) {
+    ASSERT_INPUT_THREAD();
+
+    if (!zmk_timer_is_pending(timer)) {
+        return false;
+    }
+
+    sys_dlist_remove(&timer->node);
+
+    // The wheel stays scheduled for the stopped timer. Waking up once for nothing is cheaper than
+    // finding the next deadline on every stop.
+    if (--pending_count == 0) {
+        schedule(INT64_MAX);
+    }
+
+    return true;
+}
+
+void zmk_timer_wheel_expire(int64_t timestamp) {
+    struct zmk_timer *timer, *next;
+    sys_dnode_t *node;
+
+    ASSERT_INPUT_THREAD();
+
+    if (timestamp <= next_deadline) {
+        return;
+    }
+
+    // Walk each slot at most once, even if the wheel has turned more than once since last time.
+    // The slot for wheel_time is always walked, since it holds timers started after their
+    // deadlines had passed.
+    int64_t end = CLAMP(timestamp, wheel_time + 1, wheel_time + WHEEL_SLOTS);
+
+    for (int64_t time = wheel_time; time < end; time++) {
+        SYS_DLIST_FOR_EACH_CONTAINER_SAFE(slot_for(time), timer, next, node) {
+            if (timer->deadline < timestamp) {
+                sys_dlist_remove(&timer->node);
+                sys_dlist_append(&expired, &timer->node);
+            }
+        }
+    }
+
+    wheel_time = MAX(wheel_time, timestamp);
+
+    // Handlers may start or stop any timer, including ones which have expired but not run yet.
+    while ((node = sys_dlist_get(&expired)) != NULL) {
+        timer = CONTAINER_OF(node, struct zmk_timer, node);
+        pending_count--;
+        timer->handler(timer);
+    }
+
+    schedule(find_next_deadline());
+}
+
+static void timer_wheel_work_cb(struct k_work *work) {
+    int64_t now = k_uptime_get();
+
+    if (now < next_deadline) {
+        // Woken up early by rounding to kernel ticks.
+        schedule(next_deadline);
+        return;
+    }
+
+    zmk_timer_wheel_expire(now + 1);
+}
@@ -6,31 +6,142 @@
 
 #include <zephyr/device.h>
 #include <zephyr/init.h>
+#include <zephyr/spinlock.h>
 
 #include <zephyr/usb/usb_device.h>
 #include <zephyr/usb/class/usb_hid.h>
 
+#include <zmk/endpoints.h>
 #include <zmk/usb.h>
+#include <zmk/usb_hid.h>
 #include <zmk/hid.h>
+#include <zmk/hid_merge.h>
 #include <zmk/keymap.h>
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 #include <zmk/pointing/resolution_multipliers.h>
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING_SMOOTH_SCROLLING)
 
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+#include <zmk/pointing/report_accumulator.h>
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+
 #if IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 #include <zmk/hid_indicators.h>
 #endif // IS_ENABLED(CONFIG_ZMK_HID_INDICATORS)
 
 #include <zmk/event_manager.h>
 
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+#include <zmk/latency.h>
+#endif
+
 LOG_MODULE_DECLARE(zmk, CONFIG_ZMK_LOG_LEVEL);
 
 static const struct device *hid_dev;
 
-static K_SEM_DEFINE(hid_sem, 1, 1);
+// How long to wait for the endpoint to finish a write before assuming the report was lost.
+#define TX_TIMEOUT_MS 30
+
+#define TX_QUEUE_SIZE CONFIG_ZMK_USB_HID_TX_QUEUE_SIZE
+
+// Every choice is listed, so a misspelled option fails the build instead of turning merging off.
+#if IS_ENABLED(CONFIG_ZMK_USB_HID_TX_MERGE_LOSSLESS)
+#define TX_MERGE true
+#define TX_MERGE_MODE ZMK_HID_MERGE_LOSSLESS
+#elif IS_ENABLED(CONFIG_ZMK_USB_HID_TX_MERGE_LATEST)
+#define TX_MERGE true
+#define TX_MERGE_MODE ZMK_HID_MERGE_LATEST
+#elif IS_ENABLED(CONFIG_ZMK_USB_HID_TX_MERGE_NONE)
+#define TX_MERGE false
+#define TX_MERGE_MODE ZMK_HID_MERGE_LOSSLESS
+#else
+#error "No ZMK_USB_HID_TX_MERGE choice is selected"
+#endif
+
+enum tx_queue_id {
+    TX_QUEUE_KEYBOARD,
+    TX_QUEUE_CONSUMER,
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    TX_QUEUE_MOUSE,
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    TX_QUEUE_COUNT,
+};
+
+union tx_report {
+    struct zmk_hid_keyboard_report keyboard;
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    zmk_hid_boot_report_t boot;
+#endif // IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    struct zmk_hid_consumer_report consumer;
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    struct zmk_hid_mouse_report mouse;
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+};
+
+struct tx_entry {
+    union tx_report report;
+    uint8_t len;
+    // Orders entries across report IDs.
+    uint32_t seq;
+};
+
+// Snapshots of the reports for one report ID which haven't been sent yet. The head entry stays in
+// place while the endpoint is writing it, and only the tail entry is ever merged into.
+struct tx_queue {
+    struct tx_entry entries[TX_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    // The last report handed to the endpoint, which the host's state will be based on.
+    struct tx_entry last;
+};
+
+static struct tx_queue tx_queues[TX_QUEUE_COUNT];
+static struct k_spinlock tx_lock;
+static uint32_t tx_seq;
+// Queue whose head entry the endpoint is writing, or -1 if the endpoint is idle.
+static int tx_in_flight = -1;
+static int64_t tx_started;
+static struct zmk_usb_hid_tx_stats tx_stats;
+
+static void tx_work_cb(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(tx_work, tx_work_cb);
+
+static uint8_t tx_queued_count(void) {
+    uint8_t count = 0;
+
+    for (int i = 0; i < TX_QUEUE_COUNT; i++) {
+        count += tx_queues[i].count;
+    }
+
+    return count;
+}
+
+static void tx_pop_in_flight(void) {
+    struct tx_queue *queue = &tx_queues[tx_in_flight];
+
+    queue->head = (queue->head + 1) % TX_QUEUE_SIZE;
+    queue->count--;
+    tx_in_flight = -1;
+}
+
+static void in_ready_cb(const struct device *dev) {
+#if IS_ENABLED(CONFIG_ZMK_LATENCY_TRACING)
+    zmk_latency_report_delivered();
+#endif
 
-static void in_ready_cb(const struct device *dev) { k_sem_give(&hid_sem); }
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    if (tx_in_flight >= 0) {
+        tx_pop_in_flight();
+        tx_stats.sent++;
+    }
+
+    k_work_reschedule(&tx_work, K_NO_WAIT);
+
+    k_spin_unlock(&tx_lock, key);
+}
 
 #define HID_GET_REPORT_TYPE_MASK 0xff00
 #define HID_GET_REPORT_ID_MASK 0x00ff
@@ -184,7 +295,144 @@ static const struct hid_ops ops = {
     .set_report = set_report_cb,
 };
 
-static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
+static void tx_work_cb(struct k_work *work) {
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    if (tx_in_flight >= 0) {
+        int64_t remaining = tx_started + TX_TIMEOUT_MS - k_uptime_get();
+        if (remaining > 0) {
+            k_work_reschedule(&tx_work, K_MSEC(remaining));
+            k_spin_unlock(&tx_lock, key);
+            return;
+        }
+
+        // This happens if the host resets the bus in the middle of a write.
+        LOG_WRN("Timed out waiting for the USB HID endpoint, dropping report");
+        tx_pop_in_flight();
+        tx_stats.dropped++;
+    }
+
+    int next = -1;
+    for (int i = 0; i < TX_QUEUE_COUNT; i++) {
+        struct tx_queue *queue = &tx_queues[i];
+        if (queue->count == 0) {
+            continue;
+        }
+
+        if (next < 0 ||
+            (int32_t)(queue->entries[queue->head].seq -
+                      tx_queues[next].entries[tx_queues[next].head].seq) < 0) {
+            next = i;
+        }
+    }
+
+    if (next < 0) {
+        k_spin_unlock(&tx_lock, key);
+        return;
+    }
+
+    struct tx_queue *queue = &tx_queues[next];
+    const struct tx_entry *entry = &queue->entries[queue->head];
+    queue->last = *entry;
+    tx_in_flight = next;
+    tx_started = k_uptime_get();
+
+    k_spin_unlock(&tx_lock, key);
+
+#if IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+    if (next == TX_QUEUE_KEYBOARD || next == TX_QUEUE_CONSUMER) {
+        zmk_endpoint_report_tx_ready();
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_ENDPOINT_REPORT_COALESCING)
+
+#if IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+    if (next == TX_QUEUE_MOUSE) {
+        zmk_pointing_report_tx_ready();
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING_REPORT_ACCUMULATOR)
+
+    // The entry can't change or move until it is popped, so it's safe to write from outside the
+    // lock.
+    int err = hid_int_ep_write(hid_dev, (const uint8_t *)&entry->report, entry->len, NULL);
+
+    key = k_spin_lock(&tx_lock);
+
+    if (tx_in_flight == next) {
+        if (err) {
+            LOG_WRN("Failed to write USB HID report (%d)", err);
+            tx_pop_in_flight();
+            tx_stats.dropped++;
+            k_work_reschedule(&tx_work, K_NO_WAIT);
+        } else {
+            k_work_reschedule(&tx_work, K_MSEC(TX_TIMEOUT_MS));
+        }
+    }
+
+    k_spin_unlock(&tx_lock, key);
+}
+
+static bool keyboard_reverts(const union tx_report *base, const union tx_report *pending,
+                             const union tx_report *next, size_t len) {
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    if (len == sizeof(zmk_hid_boot_report_t)) {
+        return zmk_hid_bits_revert(&base->boot.modifiers, &pending->boot.modifiers,
+                                   &next->boot.modifiers, sizeof(base->boot.modifiers)) ||
+               zmk_hid_usages_revert(base->boot.keys, pending->boot.keys, next->boot.keys,
+                                     sizeof(base->boot.keys), 1);
+    }
+#endif // IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+
+    return zmk_hid_keyboard_body_reverts(&base->keyboard.body, &pending->keyboard.body,
+                                         &next->keyboard.body);
+}
+
+/**
+ * Tries to fold @p next into @p pending, an unsent report which follows @p base.
+ */
+static bool merge_report(enum tx_queue_id id, const struct tx_entry *base,
+                         struct tx_entry *pending, const union tx_report *next, uint8_t len,
+                         enum zmk_hid_merge_mode mode) {
+    // Nothing has been sent yet if the base is empty, and it is all zeroes like a released report.
+    if (pending->len != len || (base->len != 0 && base->len != len)) {
+        // The protocol changed, so the reports aren't comparable.
+        if (mode != ZMK_HID_MERGE_FORCE) {
+            return false;
+        }
+
+        pending->report = *next;
+        pending->len = len;
+        return true;
+    }
+
+    switch (id) {
+#if IS_ENABLED(CONFIG_ZMK_POINTING)
+    case TX_QUEUE_MOUSE:
+        return zmk_hid_mouse_body_merge(&base->report.mouse.body, &pending->report.mouse.body,
+                                        &next->mouse.body, mode);
+#endif // IS_ENABLED(CONFIG_ZMK_POINTING)
+    case TX_QUEUE_KEYBOARD:
+        if (mode == ZMK_HID_MERGE_LOSSLESS &&
+            keyboard_reverts(&base->report, &pending->report, next, len)) {
+            return false;
+        }
+        break;
+    case TX_QUEUE_CONSUMER:
+        if (mode == ZMK_HID_MERGE_LOSSLESS &&
+            zmk_hid_consumer_body_reverts(&base->report.consumer.body,
+                                          &pending->report.consumer.body, &next->consumer.body)) {
+            return false;
+        }
+        break;
+    default:
+        return false;
+    }
+
+    pending->report = *next;
+    return true;
+}
+
+static int zmk_usb_hid_send_report(enum tx_queue_id id, const union tx_report *report,
+                                   uint8_t len) {
     switch (zmk_usb_get_status()) {
     case USB_DC_SUSPEND:
         return usb_wakeup_request();
@@ -194,21 +442,91 @@ static int zmk_usb_hid_send_report(const uint8_t *report, size_t len) {
     case USB_DC_UNKNOWN:
         return -ENODEV;
     default:
-        k_sem_take(&hid_sem, K_MSEC(30));
-        int err = hid_int_ep_write(hid_dev, report, len, NULL);
+        break;
+    }
 
-        if (err) {
-            k_sem_give(&hid_sem);
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+
+    struct tx_queue *queue = &tx_queues[id];
+    struct tx_entry *tail = NULL;
+    const struct tx_entry *base = &queue->last;
+
+    // The head entry can't be merged into while the endpoint is writing it.
+    bool head_in_flight = tx_in_flight == id;
+    if (queue->count > (head_in_flight ? 1 : 0)) {
+        tail = &queue->entries[(queue->head + queue->count - 1) % TX_QUEUE_SIZE];
+        if (queue->count > 1) {
+            base = &queue->entries[(queue->head + queue->count - 2) % TX_QUEUE_SIZE];
         }
+    }
 
-        return err;
+    bool merged = TX_MERGE && tail && merge_report(id, base, tail, report, len, TX_MERGE_MODE);
+
+    if (merged) {
+        tx_stats.merged++;
+    } else if (queue->count < TX_QUEUE_SIZE) {
+        struct tx_entry *entry = &queue->entries[(queue->head + queue->count) % TX_QUEUE_SIZE];
+        *entry = (struct tx_entry){.report = *report, .len = len, .seq = tx_seq++};
+        queue->count++;
+    } else {
+        // A full queue always has an unsent tail, since it holds at least two entries.
+        merge_report(id, base, tail, report, len, ZMK_HID_MERGE_FORCE);
+        tx_stats.dropped++;
     }
+
+    tx_stats.max_queued = MAX(tx_stats.max_queued, tx_queued_count());
+
+    if (tx_in_flight < 0) {
+        k_work_reschedule(&tx_work, K_NO_WAIT);
+    }
+
+    k_spin_unlock(&tx_lock, key);
+
+    return 0;
+}
+
+// True if the queue has a report behind the one the endpoint is writing, if any.
+static bool tx_queue_waiting(enum tx_queue_id id) {
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    bool waiting = tx_queues[id].count > (tx_in_flight == id ? 1 : 0);
+    k_spin_unlock(&tx_lock, key);
+
+    return waiting;
 }
 
+void zmk_usb_hid_get_tx_stats(struct zmk_usb_hid_tx_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&tx_lock);
+    *stats = tx_stats;
+    stats->queued = tx_queued_count();
+    k_spin_unlock(&tx_lock, key);
+}
+
+bool zmk_usb_hid_keyboard_report_waiting(void) { return tx_queue_waiting(TX_QUEUE_KEYBOARD); }
+
+bool zmk_usb_hid_consumer_report_waiting(void) { return tx_queue_waiting(TX_QUEUE_CONSUMER); }
+
 int zmk_usb_hid_send_keyboard_report(void) {
     size_t len;
-    uint8_t *report = get_keyboard_report(&len);
-    return zmk_usb_hid_send_report(report, len);
+    union tx_report report;
+    const uint8_t *current = get_keyboard_report(&len);
+
+    memcpy(&report, current, len);
+    return zmk_usb_hid_send_report(TX_QUEUE_KEYBOARD, &report, len);
+}
+
+int zmk_usb_hid_send_keyboard_report_body(const struct zmk_hid_keyboard_report_body *body) {
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    if (hid_protocol != HID_PROTOCOL_REPORT) {
+        union tx_report report;
+        zmk_hid_keyboard_body_to_boot_report(body, &report.boot);
+        return zmk_usb_hid_send_report(TX_QUEUE_KEYBOARD, &report, sizeof(report.boot));
+    }
+#endif
+
+    union tx_report report = {
+        .keyboard = {.report_id = ZMK_HID_REPORT_ID_KEYBOARD, .body = *body},
+    };
+    return zmk_usb_hid_send_report(TX_QUEUE_KEYBOARD, &report, sizeof(report.keyboard));
 }
 
 int zmk_usb_hid_send_consumer_report(void) {
@@ -218,8 +536,21 @@ int zmk_usb_hid_send_consumer_report(void) {
     }
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
-    struct zmk_hid_consumer_report *report = zmk_hid_get_consumer_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    union tx_report report = {.consumer = *zmk_hid_get_consumer_report()};
+    return zmk_usb_hid_send_report(TX_QUEUE_CONSUMER, &report, sizeof(report.consumer));
+}
+
+int zmk_usb_hid_send_consumer_report_body(const struct zmk_hid_consumer_report_body *body) {
+#if IS_ENABLED(CONFIG_ZMK_USB_BOOT)
+    if (hid_protocol == HID_PROTOCOL_BOOT) {
+        return -ENOTSUP;
+    }
+#endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
+
+    union tx_report report = {
+        .consumer = {.report_id = ZMK_HID_REPORT_ID_CONSUMER, .body = *body},
+    };
+    return zmk_usb_hid_send_report(TX_QUEUE_CONSUMER, &report, sizeof(report.consumer));
 }
 
 #if IS_ENABLED(CONFIG_ZMK_POINTING)
@@ -230,9 +561,11 @@ int zmk_usb_hid_send_mouse_report() {
     }
 #endif /* IS_ENABLED(CONFIG_ZMK_USB_BOOT) */
 
-    struct zmk_hid_mouse_report *report = zmk_hid_get_mouse_report();
-    return zmk_usb_hid_send_report((uint8_t *)report, sizeof(*report));
+    union tx_report report = {.mouse = *zmk_hid_get_mouse_report()};
+    return zmk_usb_hid_send_report(TX_QUEUE_MOUSE, &report, sizeof(report.mouse));
 }
+
+bool zmk_usb_hid_mouse_report_waiting(void) { return tx_queue_waiting(TX_QUEUE_MOUSE); }
 #endif // IS_ENABLED(CONFIG_ZMK_POINTING)
 
 static int zmk_usb_hid_init(void) {
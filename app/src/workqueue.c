@@ -6,19 +6,209 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
+#include <zephyr/init.h>
+
+#if IS_ENABLED(CONFIG_ZMK_WORKQUEUE_STATS)
+#include <zephyr/shell/shell.h>
+#endif
 
 #include <zmk/workqueue.h>
 
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+
+K_THREAD_STACK_DEFINE(input_q_stack, CONFIG_ZMK_INPUT_WORK_QUEUE_STACK_SIZE);
+
+static struct k_work_q input_work_q;
+
+#endif // IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+
 K_THREAD_STACK_DEFINE(lowprio_q_stack, CONFIG_ZMK_LOW_PRIORITY_THREAD_STACK_SIZE);
 
 static struct k_work_q lowprio_work_q;
 
 struct k_work_q *zmk_workqueue_lowprio_work_q(void) { return &lowprio_work_q; }
 
+#endif // IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+
+struct k_work_q *zmk_workqueue_get(enum zmk_work_class work_class) {
+    switch (work_class) {
+    case ZMK_WORK_CLASS_INPUT:
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+        return &input_work_q;
+#else
+        return &k_sys_work_q;
+#endif
+    case ZMK_WORK_CLASS_BACKGROUND:
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+        return &lowprio_work_q;
+#else
+        return &k_sys_work_q;
+#endif
+    default:
+        return &k_sys_work_q;
+    }
+}
+
+#if IS_ENABLED(CONFIG_ZMK_WORKQUEUE_STATS)
+
+struct queue_stats {
+    const char *name;
+    struct k_work_q *queue;
+    struct k_work probe;
+    uint32_t probe_submitted;
+
+    uint32_t probes;
+    uint32_t latency_max_us;
+    uint64_t latency_total_us;
+
+    uint64_t busy_cycles_base;
+};
+
+static struct queue_stats queue_stats[] = {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+    {.name = "input", .queue = &input_work_q},
+#endif
+    {.name = "system", .queue = &k_sys_work_q},
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
+    {.name = "lowprio", .queue = &lowprio_work_q},
+#endif
+};
+
+static struct k_spinlock stats_lock;
+static uint64_t total_cycles_base;
+
+static void probe_work_cb(struct k_work *work) {
+    struct queue_stats *stats = CONTAINER_OF(work, struct queue_stats, probe);
+    uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - stats->probe_submitted);
+
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    stats->probes++;
+    stats->latency_max_us = MAX(stats->latency_max_us, latency_us);
+    stats->latency_total_us += latency_us;
+
+    k_spin_unlock(&stats_lock, key);
+}
+
+// Measures how long each queue takes to get to newly submitted work by submitting a probe to it.
+static void probe_timer_cb(struct k_timer *timer) {
+    for (int i = 0; i < ARRAY_SIZE(queue_stats); i++) {
+        struct queue_stats *stats = &queue_stats[i];
+
+        // A probe still waiting from last time is already measuring a long wait.
+        if (k_work_busy_get(&stats->probe) == 0) {
+            stats->probe_submitted = k_cycle_get_32();
+            k_work_submit_to_queue(stats->queue, &stats->probe);
+        }
+    }
+}
+
+static K_TIMER_DEFINE(probe_timer, probe_timer_cb, NULL);
+
+static uint64_t thread_busy_cycles(struct k_work_q *queue) {
+    k_thread_runtime_stats_t runtime;
+
+    if (k_thread_runtime_stats_get(&queue->thread, &runtime) < 0) {
+        return 0;
+    }
+
+    return runtime.execution_cycles;
+}
+
+static uint64_t all_cycles(void) {
+    k_thread_runtime_stats_t runtime;
+
+    if (k_thread_runtime_stats_all_get(&runtime) < 0) {
+        return 0;
+    }
+
+    return runtime.execution_cycles;
+}
+
+static void reset_stats(void) {
+    k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+    for (int i = 0; i < ARRAY_SIZE(queue_stats); i++) {
+        queue_stats[i].probes = 0;
+        queue_stats[i].latency_max_us = 0;
+        queue_stats[i].latency_total_us = 0;
+        queue_stats[i].busy_cycles_base = thread_busy_cycles(queue_stats[i].queue);
+    }
+
+    total_cycles_base = all_cycles();
+
+    k_spin_unlock(&stats_lock, key);
+}
+
+static int cmd_workq_show(const struct shell *sh, size_t argc, char **argv) {
+    uint64_t total_cycles = all_cycles() - total_cycles_base;
+
+    shell_print(sh, "%-8s %6s %8s %8s %6s", "queue", "n", "avg", "max", "busy");
+
+    for (int i = 0; i < ARRAY_SIZE(queue_stats); i++) {
+        struct queue_stats *stats = &queue_stats[i];
+        uint64_t busy_cycles = thread_busy_cycles(stats->queue) - stats->busy_cycles_base;
+
+        k_spinlock_key_t key = k_spin_lock(&stats_lock);
+        uint32_t probes = stats->probes;
+        uint32_t avg_us = probes ? stats->latency_total_us / probes : 0;
+        uint32_t max_us = stats->latency_max_us;
+        k_spin_unlock(&stats_lock, key);
+
+        uint32_t busy_permille = total_cycles ? (busy_cycles * 1000) / total_cycles : 0;
+
+        shell_print(sh, "%-8s %6u %8u %8u %3u.%u%%", stats->name, probes, avg_us, max_us,
+                    busy_permille / 10, busy_permille % 10);
+    }
+
+    shell_print(sh, "Latencies are in microseconds from submitting work to it running, sampled "
+                    "every %d ms",
+                CONFIG_ZMK_WORKQUEUE_STATS_PROBE_INTERVAL);
+
+    return 0;
+}
+
+static int cmd_workq_reset(const struct shell *sh, size_t argc, char **argv) {
+    reset_stats();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_workq,
+                               SHELL_CMD(show, NULL, "Show work queue latency and busy time",
+                                         cmd_workq_show),
+                               SHELL_CMD(reset, NULL, "Clear the work queue statistics",
+                                         cmd_workq_reset),
+                               SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(workq, &sub_workq, "Work queue statistics", NULL);
+
+#endif // IS_ENABLED(CONFIG_ZMK_WORKQUEUE_STATS)
+
 static int workqueue_init(void) {
+#if IS_ENABLED(CONFIG_ZMK_INPUT_WORK_QUEUE)
+    static const struct k_work_queue_config input_queue_config = {.name = "Input Work Queue"};
+    k_work_queue_start(&input_work_q, input_q_stack, K_THREAD_STACK_SIZEOF(input_q_stack),
+                       CONFIG_ZMK_INPUT_WORK_QUEUE_PRIORITY, &input_queue_config);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_LOW_PRIORITY_WORK_QUEUE)
     static const struct k_work_queue_config queue_config = {.name = "Low Priority Work Queue"};
     k_work_queue_start(&lowprio_work_q, lowprio_q_stack, K_THREAD_STACK_SIZEOF(lowprio_q_stack),
                        CONFIG_ZMK_LOW_PRIORITY_THREAD_PRIORITY, &queue_config);
+#endif
+
+#if IS_ENABLED(CONFIG_ZMK_WORKQUEUE_STATS)
+    for (int i = 0; i < ARRAY_SIZE(queue_stats); i++) {
+        k_work_init(&queue_stats[i].probe, probe_work_cb);
+    }
+
+    reset_stats();
+    k_timer_start(&probe_timer, K_MSEC(CONFIG_ZMK_WORKQUEUE_STATS_PROBE_INTERVAL),
+                  K_MSEC(CONFIG_ZMK_WORKQUEUE_STATS_PROBE_INTERVAL));
+#endif
+
     return 0;
 }
 
@@ -104,6 +104,7 @@ module.exports = {
           items: [
             "keymaps/input-processors/usage",
             "keymaps/input-processors/scaler",
+            "keymaps/input-processors/acceleration",
             "keymaps/input-processors/transformer",
             "keymaps/input-processors/code-mapper",
             "keymaps/input-processors/temp-layer",